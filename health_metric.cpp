@@ -3,6 +3,7 @@
 #include "health_metric.hpp"
 
 #include <phosphor-logging/lg2.hpp>
+#include <xyz/openbmc_project/Common/error.hpp>
 
 #include <cmath>
 #include <numeric>
@@ -15,6 +16,90 @@ namespace phosphor::health::metric
 
 using association_t = std::tuple<std::string, std::string, std::string>;
 
+static constexpr auto valueProperty = "Value";
+static constexpr auto assertedProperty = "Asserted";
+static constexpr auto hysteresisProperty = "Hysteresis";
+static constexpr auto windowSizeProperty = "WindowSize";
+
+const sdbusplus::vtable_t HealthMetric::tuningVtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::property(hysteresisProperty, "d",
+                                HealthMetric::getHysteresis,
+                                HealthMetric::setHysteresis,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::property(windowSizeProperty, "t",
+                                HealthMetric::getWindowSize,
+                                HealthMetric::setWindowSize,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::end()};
+
+int HealthMetric::getHysteresis(sd_bus* /*bus*/, const char* /*path*/,
+                                const char* /*interface*/,
+                                const char* /*property*/, sd_bus_message* reply,
+                                void* context, sd_bus_error* /*retError*/)
+{
+    auto self = static_cast<HealthMetric*>(context);
+    return sd_bus_message_append_basic(reply, 'd', &self->config.hysteresis);
+}
+
+int HealthMetric::setHysteresis(sd_bus* /*bus*/, const char* /*path*/,
+                                const char* /*interface*/,
+                                const char* /*property*/, sd_bus_message* value,
+                                void* context, sd_bus_error* retError)
+{
+    auto self = static_cast<HealthMetric*>(context);
+    double hysteresis = 0;
+    if (auto r = sd_bus_message_read_basic(value, 'd', &hysteresis); r < 0)
+    {
+        return r;
+    }
+    if (!std::isfinite(hysteresis) || hysteresis < 0)
+    {
+        return sd_bus_error_set_errno(retError, EINVAL);
+    }
+    if (hysteresis != self->config.hysteresis)
+    {
+        self->config.hysteresis = hysteresis;
+        self->saveOverride();
+        self->tuningInterface.property_changed(hysteresisProperty);
+    }
+    return 1;
+}
+
+int HealthMetric::getWindowSize(sd_bus* /*bus*/, const char* /*path*/,
+                                const char* /*interface*/,
+                                const char* /*property*/, sd_bus_message* reply,
+                                void* context, sd_bus_error* /*retError*/)
+{
+    auto self = static_cast<HealthMetric*>(context);
+    uint64_t windowSize = self->config.windowSize;
+    return sd_bus_message_append_basic(reply, 't', &windowSize);
+}
+
+int HealthMetric::setWindowSize(sd_bus* /*bus*/, const char* /*path*/,
+                                const char* /*interface*/,
+                                const char* /*property*/, sd_bus_message* value,
+                                void* context, sd_bus_error* retError)
+{
+    auto self = static_cast<HealthMetric*>(context);
+    uint64_t windowSize = 0;
+    if (auto r = sd_bus_message_read_basic(value, 't', &windowSize); r < 0)
+    {
+        return r;
+    }
+    if (windowSize == 0)
+    {
+        return sd_bus_error_set_errno(retError, EINVAL);
+    }
+    if (windowSize != self->config.windowSize)
+    {
+        self->resizeWindow(windowSize);
+        self->saveOverride();
+        self->tuningInterface.property_changed(windowSizeProperty);
+    }
+    return 1;
+}
+
 auto HealthMetric::getPath(MType type, std::string name, SubType subType)
     -> std::string
 {
@@ -138,7 +223,11 @@ void HealthMetric::initProperties()
         }
     }
     ValueIntf::value(std::numeric_limits<double>::quiet_NaN(), true);
+    initThresholds(true);
+}
 
+void HealthMetric::initThresholds(bool skipSignal)
+{
     using bound_map_t = std::map<Bound, double>;
     std::map<Type, bound_map_t> thresholds;
     for (const auto& [key, value] : config.thresholds)
@@ -157,7 +246,96 @@ void HealthMetric::initProperties()
             threshold->second.emplace(bound, value.value);
         }
     }
-    ThresholdIntf::value(thresholds, true);
+    ThresholdIntf::value(thresholds, skipSignal);
+}
+
+void HealthMetric::reconfigure(const config::HealthMetric& newConfig)
+{
+    auto tuningChanged = (config.windowSize != newConfig.windowSize ||
+                          config.hysteresis != newConfig.hysteresis);
+    config = newConfig;
+    resizeWindow(config.windowSize);
+    if (tuningChanged)
+    {
+        tuningInterface.property_changed(hysteresisProperty);
+        tuningInterface.property_changed(windowSizeProperty);
+    }
+
+    initThresholds(false);
+
+    std::erase_if(thresholdStates, [this](const auto& state) {
+        return !config.thresholds.contains(state.first);
+    });
+
+    // Drop assertions of thresholds which are no longer configured
+    auto assertions = ThresholdIntf::asserted();
+    auto count = std::erase_if(assertions, [this](const auto& threshold) {
+        return !config.thresholds.contains(threshold);
+    });
+    if (count > 0)
+    {
+        ThresholdIntf::asserted(assertions);
+    }
+}
+
+auto HealthMetric::value(std::map<Type, std::map<Bound, double>> values)
+    -> std::map<Type, std::map<Bound, double>>
+{
+    using sdbusplus::xyz::openbmc_project::Common::Error::InvalidArgument;
+    using sdbusplus::xyz::openbmc_project::Common::Error::Unavailable;
+
+    // Validate the whole write before applying any of it
+    for (const auto& [type, bounds] : values)
+    {
+        for (const auto& [bound, value] : bounds)
+        {
+            if (!config.thresholds.contains({type, bound}) ||
+                !std::isfinite(value))
+            {
+                throw InvalidArgument();
+            }
+        }
+    }
+    if (!std::isfinite(lastTotal) || lastTotal <= 0)
+    {
+        // No sample yet to convert the absolute values to percent
+        throw Unavailable();
+    }
+
+    auto thresholds = ThresholdIntf::value();
+    for (const auto& [type, bounds] : values)
+    {
+        for (const auto& [bound, value] : bounds)
+        {
+            auto& tConfig = config.thresholds.at({type, bound});
+            tConfig.value = value / lastTotal * 100;
+            thresholds[type][bound] = value;
+            info("Health Metric {METRIC} {TYPE} {BOUND} threshold set to "
+                 "{VALUE}%",
+                 "METRIC", config.name, "TYPE", type, "BOUND", bound, "VALUE",
+                 tConfig.value);
+        }
+    }
+    saveOverride();
+    return ThresholdIntf::value(thresholds);
+}
+
+void HealthMetric::resizeWindow(size_t windowSize)
+{
+    config.windowSize = windowSize;
+    while (history.size() > config.windowSize)
+    {
+        history.pop_front();
+    }
+}
+
+void HealthMetric::saveOverride()
+{
+    if (!config::saveOverride(config))
+    {
+        warning("Failed to persist tuning of Health Metric {METRIC}",
+                "METRIC", config.name);
+    }
 }
 
 bool didThresholdViolate(ThresholdIntf::Bound bound, double thresholdValue,
@@ -191,14 +369,19 @@ void HealthMetric::checkThreshold(Type type, Bound bound, MValue value)
         auto tConfig = config.thresholds.at(threshold);
         auto thresholdValue = tConfig.value / 100 * value.total;
         thresholds[type][bound] = thresholdValue;
-        ThresholdIntf::value(thresholds);
+        setThresholdValues(thresholds);
         auto assertions = ThresholdIntf::asserted();
+        auto& state = thresholdStates[threshold];
+        auto now = clock_t::now();
         if (didThresholdViolate(bound, thresholdValue, value.current))
         {
+            state.violatedAt = now;
             if (!assertions.contains(threshold))
             {
+                state.assertedAt = now;
+                recordTransition(type, bound, tConfig, state, now);
                 assertions.insert(threshold);
-                ThresholdIntf::asserted(assertions);
+                setAsserted(assertions);
                 ThresholdIntf::assertionChanged(type, bound, true,
                                                 value.current);
                 if (tConfig.log)
@@ -206,10 +389,7 @@ void HealthMetric::checkThreshold(Type type, Bound bound, MValue value)
                     error(
                         "ASSERT: Health Metric {METRIC} crossed {TYPE} upper threshold",
                         "METRIC", config.name, "TYPE", type);
-                    if ((type == Threshold::Type::Critical &&
-                         checkCriticalLogRateLimitWindow()) ||
-                        (type == Threshold::Type::Warning &&
-                         checkWarningLogRateLimitWindow()))
+                    if (allowAction(type, bound, tConfig))
                     {
                         std::string path = "";
                         phosphor::health::utils::createThresholdLogEntry(
@@ -253,8 +433,38 @@ void HealthMetric::checkThreshold(Type type, Bound bound, MValue value)
         }
         else if (assertions.contains(threshold))
         {
+            // Deassert only once the value cleared the limit by the deassert
+            // hysteresis, the hold time passed and the threshold is not held
+            // for flapping
+            auto deassertValue =
+                (bound == Bound::Upper
+                     ? tConfig.value - tConfig.deassertHysteresis
+                     : tConfig.value + tConfig.deassertHysteresis) /
+                100 * value.total;
+            if (didThresholdViolate(bound, deassertValue, value.current) ||
+                now - state.assertedAt < tConfig.holdTime)
+            {
+                return;
+            }
+            if (state.flapping)
+            {
+                if (now - state.violatedAt < tConfig.flapWindow)
+                {
+                    return;
+                }
+                state.flapping = false;
+                info("Health Metric {METRIC} {TYPE} {BOUND} threshold stopped "
+                     "flapping",
+                     "METRIC", config.name, "TYPE", type, "BOUND", bound);
+            }
+            recordTransition(type, bound, tConfig, state, now);
+            if (state.flapping)
+            {
+                // This deassert started the flapping, stay asserted
+                return;
+            }
             assertions.erase(threshold);
-            ThresholdIntf::asserted(assertions);
+            setAsserted(assertions);
             ThresholdIntf::assertionChanged(type, bound, false, value.current);
             if (config.thresholds.find(threshold)->second.log)
             {
@@ -266,6 +476,32 @@ void HealthMetric::checkThreshold(Type type, Bound bound, MValue value)
     }
 }
 
+void HealthMetric::recordTransition(Type type, Bound bound,
+                                    const config::Threshold& tConfig,
+                                    ThresholdState& state,
+                                    clock_t::time_point now)
+{
+    if (tConfig.flapCount == 0)
+    {
+        return;
+    }
+    state.transitions.push_back(now);
+    while (now - state.transitions.front() > tConfig.flapWindow)
+    {
+        state.transitions.pop_front();
+    }
+    if (!state.flapping && state.transitions.size() >= tConfig.flapCount)
+    {
+        // Hold the threshold asserted, which bounds the signals, log entries
+        // and units started to flapCount per flapWindow
+        state.flapping = true;
+        state.transitions.clear();
+        warning("Health Metric {METRIC} {TYPE} {BOUND} threshold is flapping, "
+                "holding it asserted",
+                "METRIC", config.name, "TYPE", type, "BOUND", bound);
+    }
+}
+
 void HealthMetric::checkThresholds(MValue value)
 {
     if (!waitForActionDelay() && !ThresholdIntf::value().empty())
@@ -297,7 +533,8 @@ auto HealthMetric::shouldNotify(MValue value) -> bool
 
 void HealthMetric::update(MValue value)
 {
-    ValueIntf::value(value.current, !shouldNotify(value));
+    lastTotal = value.total;
+    setValue(value.current, !shouldNotify(value));
 
     // Maintain window size for threshold calculation
     if (history.size() >= config.windowSize)
@@ -306,27 +543,161 @@ void HealthMetric::update(MValue value)
     }
 
     history.push_back(value.current);
-    if (history.size() < config.windowSize)
+    // Wait for the metric to have enough samples to calculate average
+    if (history.size() >= config.windowSize)
     {
-        // Wait for the metric to have enough samples to calculate average
+        double average =
+            (std::accumulate(history.begin(), history.end(), 0.0)) /
+            history.size();
+        value.current = average;
+#ifdef ENABLE_info
+        info("Health Metric: {METRIC} average value: {VALUE}", "METRIC",
+             config.name, "VALUE", value.current);
+#endif
+        checkThresholds(value);
+    }
+
+    for (auto sink : sinks)
+    {
+        sink->updated(*this);
+    }
+}
+
+void HealthMetric::setValue(double value, bool skipSignal)
+{
+    if (batcher == nullptr || skipSignal)
+    {
+        ValueIntf::value(value, skipSignal);
         return;
     }
+    if (ValueIntf::value() != value)
+    {
+        ValueIntf::value(value, true);
+        batcher->changed(objectPath, ValueIntf::interface, valueProperty);
+    }
+}
 
-    double average = (std::accumulate(history.begin(), history.end(), 0.0)) /
-                     history.size();
-    value.current = average;
-#ifdef ENABLE_info
-    info("Health Metric: {METRIC} average value: {VALUE}", "METRIC",
-         config.name, "VALUE", value.current);
-#endif
-    checkThresholds(value);
+void HealthMetric::setThresholdValues(
+    const std::map<Type, std::map<Bound, double>>& values)
+{
+    if (batcher == nullptr)
+    {
+        ThresholdIntf::value(values, false);
+        return;
+    }
+    if (ThresholdIntf::value() != values)
+    {
+        ThresholdIntf::value(values, true);
+        batcher->changed(objectPath, ThresholdIntf::interface, valueProperty);
+    }
+}
+
+void HealthMetric::setAsserted(
+    const std::set<std::tuple<Type, Bound>>& assertions)
+{
+    if (batcher == nullptr)
+    {
+        ThresholdIntf::asserted(assertions, false);
+        return;
+    }
+    if (ThresholdIntf::asserted() != assertions)
+    {
+        ThresholdIntf::asserted(assertions, true);
+        batcher->changed(objectPath, ThresholdIntf::interface,
+                         assertedProperty);
+    }
+}
+
+auto HealthMetric::getState() const -> state::Metric
+{
+    state::Metric saved{.history = {history.begin(), history.end()},
+                        .lastTotal = lastTotal,
+                        .lastNotifiedValue = lastNotifiedValue,
+                        .thresholds = {}};
+    auto assertions = ThresholdIntf::asserted();
+    for (const auto& [threshold, tState] : thresholdStates)
+    {
+        saved.thresholds.push_back(
+            {.type = std::get<Type>(threshold),
+             .bound = std::get<Bound>(threshold),
+             .asserted = assertions.contains(threshold),
+             .flapping = tState.flapping,
+             .assertedAt = tState.assertedAt,
+             .violatedAt = tState.violatedAt,
+             .transitions = {tState.transitions.begin(),
+                             tState.transitions.end()}});
+    }
+    return saved;
+}
+
+void HealthMetric::restoreState(const state::Metric& saved)
+{
+    history.assign(saved.history.begin(), saved.history.end());
+    while (history.size() > config.windowSize)
+    {
+        history.pop_front();
+    }
+    lastTotal = saved.lastTotal;
+    lastNotifiedValue = saved.lastNotifiedValue;
+    if (!history.empty())
+    {
+        ValueIntf::value(history.back(), true);
+    }
+
+    // The assertions were signaled by the previous instance, only the
+    // thresholds still configured are restored
+    auto assertions = ThresholdIntf::asserted();
+    for (const auto& threshold : saved.thresholds)
+    {
+        auto key = std::make_tuple(threshold.type, threshold.bound);
+        if (!config.thresholds.contains(key))
+        {
+            continue;
+        }
+        auto& tState = thresholdStates[key];
+        tState.assertedAt = threshold.assertedAt;
+        tState.violatedAt = threshold.violatedAt;
+        tState.transitions.assign(threshold.transitions.begin(),
+                                  threshold.transitions.end());
+        tState.flapping = threshold.flapping;
+        if (threshold.asserted)
+        {
+            assertions.insert(key);
+        }
+    }
+    ThresholdIntf::asserted(assertions, true);
+    debug("Restored state of Health Metric {METRIC} with {COUNT} samples",
+          "METRIC", config.name, "COUNT", history.size());
+}
+
+auto HealthMetric::getAssertionMask() const -> uint32_t
+{
+    uint32_t mask = 0;
+    for (const auto& [type, bound] : ThresholdIntf::asserted())
+    {
+        mask |= assertionBit(type, bound);
+    }
+    return mask;
+}
+
+HealthMetric::~HealthMetric()
+{
+    tuningInterface.emit_removed();
+    for (auto sink : sinks)
+    {
+        sink->removed(*this);
+    }
 }
 
 void HealthMetric::create(const paths_t& bmcPaths)
 {
     info("Create Health Metric: {METRIC}", "METRIC", config.name);
     initProperties();
+    setAssociations(bmcPaths);
+}
 
+void HealthMetric::setAssociations(const paths_t& bmcPaths)
+{
     std::vector<association_t> associations;
     static constexpr auto forwardAssociation = "measuring";
     static constexpr auto reverseAssociation = "measured_by";
@@ -342,48 +713,17 @@ void HealthMetric::create(const paths_t& bmcPaths)
     AssociationIntf::associations(associations);
 }
 
-bool HealthMetric::checkCriticalLogRateLimitWindow()
-{
-    if (!std::chrono::duration_cast<std::chrono::seconds>(
-             lastCriticalLogLoggedTime.time_since_epoch())
-             .count())
-    {
-        // Update the last Critical log loggedTime
-        lastCriticalLogLoggedTime = std::chrono::high_resolution_clock::now();
-        return true;
-    }
-    std::chrono::duration<double> diff =
-        std::chrono::high_resolution_clock::now() - lastCriticalLogLoggedTime;
-    // using namespace phosphor::health::metric::config;
-    if (diff.count() > LOG_RATE_LIMIT)
-    {
-        // Update the last Critical log loggedTime
-        lastCriticalLogLoggedTime = std::chrono::high_resolution_clock::now();
-        return true;
-    }
-    return false;
-}
-
-bool HealthMetric::checkWarningLogRateLimitWindow()
+auto HealthMetric::allowAction(Type type, Bound bound,
+                               const config::Threshold& tConfig) -> bool
 {
-    if (!std::chrono::duration_cast<std::chrono::seconds>(
-             lastWarningLogLoggedTime.time_since_epoch())
-             .count())
-    {
-        // Update the last warning log loggedTime
-        lastWarningLogLoggedTime = std::chrono::high_resolution_clock::now();
-        return true;
-    }
-    std::chrono::duration<double> diff =
-        std::chrono::high_resolution_clock::now() - lastWarningLogLoggedTime;
-    // using namespace phosphor::health::metric::config;
-    if (diff.count() > LOG_RATE_LIMIT)
-    {
-        // Update the last warning log loggedTime
-        lastWarningLogLoggedTime = std::chrono::high_resolution_clock::now();
-        return true;
-    }
-    return false;
+    auto period = tConfig.rateLimitPeriod.count() > 0
+                      ? tConfig.rateLimitPeriod
+                      : std::chrono::seconds(LOG_RATE_LIMIT);
+    return actionLimiter.allow(
+        {.metric = config.name, .type = type, .bound = bound,
+         .target = tConfig.target},
+        {.burst = static_cast<double>(tConfig.rateLimitBurst),
+         .period = period});
 }
 
 void HealthMetric::setwaitForActionDelay(bool value)
@@ -395,9 +735,10 @@ bool HealthMetric::waitForActionDelay()
 {
     if (waitForAction)
     {
-        std::chrono::duration<double> diff =
-            std::chrono::high_resolution_clock::now() - bootTime;
-        if (diff.count() > BOOT_DELAY)
+        // Based on the system uptime, so that a restart of the daemon does
+        // not delay the actions again
+        if (phosphor::health::utils::getUptime() >
+            std::chrono::seconds(BOOT_DELAY))
         {
             waitForAction = false;
         }
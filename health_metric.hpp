@@ -1,14 +1,26 @@
 #pragma once
 
+#include "health_metric_batcher.hpp"
 #include "health_metric_config.hpp"
+#include "health_metric_sink.hpp"
+#include "health_metric_state.hpp"
+#include "health_rate_limiter.hpp"
 #include "health_utils.hpp"
 
+#include <sdbusplus/server/interface.hpp>
+#include <sdbusplus/vtable.hpp>
 #include <xyz/openbmc_project/Association/Definitions/server.hpp>
 #include <xyz/openbmc_project/Inventory/Item/Bmc/server.hpp>
 #include <xyz/openbmc_project/Metric/Value/server.hpp>
 
+#include <chrono>
 #include <deque>
+#include <limits>
+#include <map>
+#include <set>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 namespace phosphor::health::metric
 {
@@ -26,6 +38,9 @@ using BmcIntf = sdbusplus::xyz::openbmc_project::Inventory::Item::server::Bmc;
 using MetricIntf =
     sdbusplus::server::object_t<ValueIntf, ThresholdIntf, AssociationIntf>;
 
+/** @brief D-Bus interface with the writable metric tuning properties */
+static constexpr auto TuningIntf = "xyz.openbmc_project.HealthMon.Tuning";
+
 struct MValue
 {
     /** @brief Current value of metric */
@@ -42,20 +57,20 @@ class HealthMetric : public MetricIntf
     HealthMetric() = delete;
     HealthMetric(const HealthMetric&) = delete;
     HealthMetric(HealthMetric&&) = delete;
-    virtual ~HealthMetric() = default;
+    virtual ~HealthMetric();
 
     HealthMetric(sdbusplus::bus_t& bus, MType type,
                  const config::HealthMetric& config, const paths_t& bmcPaths) :
-        MetricIntf(bus, getPath(type, config.name, config.subType).c_str(),
-                   action::defer_emit),
-        bus(bus), type(type), config(config)
-    {
-        create(bmcPaths);
-        this->emit_object_added();
-    }
+        HealthMetric(bus, type, config, bmcPaths,
+                     getPath(type, config.name, config.subType))
+    {}
 
     /** @brief Update the health metric with the given value */
     void update(MValue value);
+    /** @brief Apply a new config while keeping the sample window */
+    void reconfigure(const config::HealthMetric& newConfig);
+    /** @brief Associate the metric with the BMC inventory paths */
+    void setAssociations(const paths_t& bmcPaths);
     /** @brief Set the process ID for the metric */
     void setPid(int pid)
     {
@@ -71,54 +86,203 @@ class HealthMetric : public MetricIntf
     static void setwaitForActionDelay(bool value);
     /*Wait for the action delay*/
     static bool waitForActionDelay();
-    /** @brief Set the boot time */
-    static void setBootTime(
-        std::chrono::time_point<std::chrono::high_resolution_clock> time)
+    /** @brief Register a sink to be notified of every metric update */
+    static void addSink(MetricSink& sink)
+    {
+        sinks.push_back(&sink);
+    }
+    /** @brief Defer the PropertiesChanged signals of all metrics to the
+     *         batcher, nullptr sends them right away
+     *
+     *  The batcher should also be added as a sink, so that it is flushed at
+     *  the end of every collection tick.
+     */
+    static void setBatcher(batch::Batcher* newBatcher)
+    {
+        batcher = newBatcher;
+    }
+    /** @brief Restore the state of the metrics created from now on and of
+     *         the action rate limits from the store, nullptr to disable
+     *
+     *  The store should also be added as a sink, so that it saves the state.
+     */
+    static void setStore(state::Store* newStore)
     {
-        bootTime = time;
+        store = newStore;
+        if (store != nullptr)
+        {
+            actionLimiter.restore(store->getRateLimits());
+        }
+    }
+    /** @brief Get the rate limiter of the threshold actions */
+    static auto getActionLimiter() -> const ratelimit::RateLimiter&
+    {
+        return actionLimiter;
+    }
+    /** @brief Notify the sinks that a collection tick completed */
+    static void flushSinks()
+    {
+        for (auto sink : sinks)
+        {
+            sink->flush();
+        }
+    }
+
+    /** @brief Get the configured name of the metric */
+    auto getName() const -> const std::string&
+    {
+        return config.name;
+    }
+    /** @brief Get the D-Bus object path of the metric */
+    auto getObjectPath() const -> const std::string&
+    {
+        return objectPath;
+    }
+    /** @brief Get the object path for the given type, name and subtype,
+     *         the part of the name after its last '_' is lowercased */
+    static auto getPath(MType type, std::string name, SubType subType)
+        -> std::string;
+    /** @brief Set the threshold values from a D-Bus property write
+     *
+     *  The values are absolute like the published ones, they are converted
+     *  to percent of the latest total and update the config, so that they
+     *  take effect on the next sample. The sample history is kept.
+     */
+    auto value(std::map<Type, std::map<Bound, double>> values)
+        -> std::map<Type, std::map<Bound, double>> override;
+
+    /** @brief Get the runtime state, to persist it across restarts */
+    auto getState() const -> state::Metric;
+
+    /** @brief Get the asserted thresholds as a bitmask, see assertionBit() */
+    auto getAssertionMask() const -> uint32_t;
+    /** @brief Bit in the assertion mask for the given threshold */
+    static constexpr auto assertionBit(Type type, Bound bound) -> uint32_t
+    {
+        return 1u << (std::to_underlying(type) * 2 + std::to_underlying(bound));
     }
 
   private:
+    using clock_t = std::chrono::steady_clock;
+
+    /** @brief Runtime state of a threshold for hold time and flapping */
+    struct ThresholdState
+    {
+        /** @brief Time of the last assertion */
+        clock_t::time_point assertedAt;
+        /** @brief Time of the last sample which violated the threshold */
+        clock_t::time_point violatedAt;
+        /** @brief Times of the recent assert and deassert transitions */
+        std::deque<clock_t::time_point> transitions;
+        /** @brief Set while the threshold is held asserted for flapping */
+        bool flapping = false;
+    };
+
+    HealthMetric(sdbusplus::bus_t& bus, MType type,
+                 const config::HealthMetric& config, const paths_t& bmcPaths,
+                 const std::string& path) :
+        MetricIntf(bus, path.c_str(), action::defer_emit), bus(bus),
+        type(type), config(config), objectPath(path),
+        tuningInterface(bus, path.c_str(), TuningIntf, tuningVtable, this)
+    {
+        create(bmcPaths);
+        if (store != nullptr)
+        {
+            if (auto saved = store->find(objectPath); saved != nullptr)
+            {
+                restoreState(*saved);
+            }
+        }
+        this->emit_object_added();
+        for (auto sink : sinks)
+        {
+            sink->added(*this);
+        }
+    }
+
+    /** @brief Property getters and setters of the tuning interface */
+    static int getHysteresis(sd_bus* bus, const char* path,
+                             const char* interface, const char* property,
+                             sd_bus_message* reply, void* context,
+                             sd_bus_error* retError);
+    static int setHysteresis(sd_bus* bus, const char* path,
+                             const char* interface, const char* property,
+                             sd_bus_message* value, void* context,
+                             sd_bus_error* retError);
+    static int getWindowSize(sd_bus* bus, const char* path,
+                             const char* interface, const char* property,
+                             sd_bus_message* reply, void* context,
+                             sd_bus_error* retError);
+    static int setWindowSize(sd_bus* bus, const char* path,
+                             const char* interface, const char* property,
+                             sd_bus_message* value, void* context,
+                             sd_bus_error* retError);
+    /** @brief Apply a window size, dropping the oldest samples if needed */
+    void resizeWindow(size_t windowSize);
+    /** @brief Persist the runtime tuning, if enabled */
+    void saveOverride();
+
     /** @brief Create a new health metric object */
     void create(const paths_t& bmcPaths);
+    /** @brief Restore the runtime state saved by a previous instance */
+    void restoreState(const state::Metric& saved);
     /** @brief Init properties for the health metric object */
     void initProperties();
+    /** @brief Init the threshold properties from the config */
+    void initThresholds(bool skipSignal);
     /** @brief Check if specified value should be notified based on hysteresis
      */
     auto shouldNotify(MValue value) -> bool;
     /** @brief Check specified threshold for the given value */
     void checkThreshold(Type type, Bound bound, MValue value);
+    /** @brief Record an assert or deassert transition for flap detection */
+    void recordTransition(Type type, Bound bound,
+                          const config::Threshold& tConfig,
+                          ThresholdState& state, clock_t::time_point now);
     /** @brief Check all thresholds for the given value */
     void checkThresholds(MValue value);
-    /** @brief Get the object path for the given type, name and subtype */
-    auto getPath(MType type, std::string name, SubType subType) -> std::string;
-    /** @brief Check if the metric is in critical state */
-    auto checkCriticalLogRateLimitWindow() -> bool;
-    /** @brief Check if the metric is in warning state */
-    auto checkWarningLogRateLimitWindow() -> bool;
-    /** @brief last logged time for critical log */
-    std::chrono::time_point<std::chrono::high_resolution_clock>
-        lastCriticalLogLoggedTime;
-    /** @brief last logged time for warning log */
-    std::chrono::time_point<std::chrono::high_resolution_clock>
-        lastWarningLogLoggedTime;
+    /** @brief Set the metric value, the signal is batched if enabled */
+    void setValue(double value, bool skipSignal);
+    /** @brief Set the threshold values, the signal is batched if enabled */
+    void setThresholdValues(const std::map<Type, std::map<Bound, double>>& values);
+    /** @brief Set the asserted thresholds, the signal is batched if enabled */
+    void setAsserted(const std::set<std::tuple<Type, Bound>>& assertions);
+    /** @brief Check if the threshold actions may be taken now */
+    auto allowAction(Type type, Bound bound, const config::Threshold& tConfig)
+        -> bool;
     /** @brief D-Bus bus connection */
     sdbusplus::bus_t& bus;
     /** @brief Metric type */
     MType type;
     /** @brief Metric configuration */
-    const config::HealthMetric config;
+    config::HealthMetric config;
+    /** @brief D-Bus object path of the metric */
+    const std::string objectPath;
+    /** @brief D-Bus vtable of the tuning interface */
+    static const sdbusplus::vtable_t tuningVtable[];
+    /** @brief Tuning D-Bus interface */
+    sdbusplus::server::interface_t tuningInterface;
+    /** @brief Runtime state of the configured thresholds */
+    std::map<std::tuple<Type, Bound>, ThresholdState> thresholdStates;
     /** @brief Window for metric history */
     std::deque<double> history;
+    /** @brief Total of the latest sample, to convert absolute threshold
+     *         values to percent */
+    double lastTotal = std::numeric_limits<double>::quiet_NaN();
     /** @brief Last notified value for the metric change */
     double lastNotifiedValue = 0;
     /** @brief Process ID for the metric */
     int pid = 0;
-    /** @brief boot time */
-    inline static std::chrono::time_point<std::chrono::high_resolution_clock>
-        bootTime;
     /* @brief wait for action delay */
     inline static bool waitForAction = true;
+    /** @brief Rate limiter of the threshold actions of all metrics */
+    inline static ratelimit::RateLimiter actionLimiter;
+    /** @brief Store of the runtime state, if enabled */
+    inline static state::Store* store = nullptr;
+    /** @brief Batcher of the PropertiesChanged signals, if enabled */
+    inline static batch::Batcher* batcher = nullptr;
+    /** @brief Sinks notified of metric updates */
+    inline static std::vector<MetricSink*> sinks;
 };
 
 } // namespace phosphor::health::metric
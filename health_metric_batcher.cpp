@@ -0,0 +1,72 @@
+#include "health_metric_batcher.hpp"
+
+#include "health_metric.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+
+PHOSPHOR_LOG2_USING;
+
+namespace phosphor::health::metric::batch
+{
+
+void Batcher::changed(const std::string& path, const char* interface,
+                      const char* property)
+{
+    counters.changes++;
+    tickChanges++;
+    auto& properties = pending[path][interface];
+    if (std::ranges::find(properties, std::string_view(property),
+                          [](const char* name) {
+        return std::string_view(name);
+    }) == properties.end())
+    {
+        properties.push_back(property);
+    }
+}
+
+void Batcher::removed(const HealthMetric& metric)
+{
+    // The object is gone, its pending changes must not be sent
+    pending.erase(metric.getObjectPath());
+}
+
+void Batcher::flush()
+{
+    if (pending.empty())
+    {
+        return;
+    }
+
+    auto signals = counters.signals;
+    for (auto& [path, interfaces] : pending)
+    {
+        for (auto& [interface, properties] : interfaces)
+        {
+            properties.push_back(nullptr);
+            auto rc =
+                bus.getInterface()->sd_bus_emit_properties_changed_strv(
+                    bus.get(), path.c_str(), interface.data(),
+                    properties.data());
+            if (rc < 0)
+            {
+                error("Failed to emit PropertiesChanged for {PATH}: {ERROR}",
+                      "PATH", path, "ERROR", rc);
+                continue;
+            }
+            counters.signals++;
+        }
+    }
+    pending.clear();
+    auto changes = tickChanges;
+    tickChanges = 0;
+
+    debug("Sent {SIGNALS} PropertiesChanged signals for {CHANGES} property "
+          "changes, {TOTAL_SIGNALS} for {TOTAL_CHANGES} since startup",
+          "SIGNALS", counters.signals - signals, "CHANGES", changes,
+          "TOTAL_SIGNALS", counters.signals,
+          "TOTAL_CHANGES", counters.changes);
+}
+
+} // namespace phosphor::health::metric::batch
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "health_metric_sink.hpp"
+
+#include <sdbusplus/bus.hpp>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace phosphor::health::metric::batch
+{
+
+/** @brief Counters to compare the signals sent with and without batching */
+struct Stats
+{
+    /** @brief Property changes queued, each was a signal without batching */
+    uint64_t changes = 0;
+    /** @brief PropertiesChanged signals sent */
+    uint64_t signals = 0;
+};
+
+/** @class Batcher
+ *  @brief Defers PropertiesChanged signals of the metric objects to the end
+ *         of the collection tick
+ *
+ *  All properties of an interface which changed during a tick are sent in a
+ *  single PropertiesChanged signal on flush(), so each metric sends at most
+ *  one signal per interface and tick, instead of one per property write.
+ */
+class Batcher : public MetricSink
+{
+  public:
+    Batcher() = delete;
+    Batcher(const Batcher&) = delete;
+    Batcher& operator=(const Batcher&) = delete;
+    Batcher(Batcher&&) = delete;
+    Batcher& operator=(Batcher&&) = delete;
+    ~Batcher() override = default;
+
+    explicit Batcher(sdbusplus::bus_t& bus) : bus(bus) {}
+
+    /** @brief Queue a changed property
+     *
+     *  The interface and property must be string literals, they are kept
+     *  until the next flush.
+     */
+    void changed(const std::string& path, const char* interface,
+                 const char* property);
+
+    void added(const HealthMetric&) override {}
+    void updated(const HealthMetric&) override {}
+    /** @brief Drop the pending changes of a removed metric */
+    void removed(const HealthMetric& metric) override;
+    /** @brief Send one PropertiesChanged per changed object interface */
+    void flush() override;
+
+    /** @brief Get the counters since startup */
+    auto stats() const -> const Stats&
+    {
+        return counters;
+    }
+
+  private:
+    using properties_t = std::vector<const char*>;
+
+    /** @brief sdbusplus bus client connection */
+    sdbusplus::bus_t& bus;
+    /** @brief Changed properties by object path and interface */
+    std::map<std::string, std::map<std::string_view, properties_t>> pending;
+    /** @brief Counters since startup */
+    Stats counters;
+    /** @brief Property changes queued since the last flush */
+    uint64_t tickChanges = 0;
+};
+
+} // namespace phosphor::health::metric::batch
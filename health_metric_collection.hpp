@@ -1,6 +1,10 @@
 #pragma once
 
 #include "health_metric.hpp"
+#include "health_metric_pattern.hpp"
+#include "health_metric_sampler.hpp"
+
+#include <algorithm>
 
 namespace phosphor::health::metric::collection
 {
@@ -21,8 +25,16 @@ class HealthMetricCollection
         create(bmcPaths);
     }
 
-    /** @brief Read the health metric collection from the system */
+    /** @brief Read the health metric collection from the system
+     *
+     *  Samples and applies the values on the calling thread, the monitor
+     *  samples on the collector thread instead, see sources() and apply().
+     */
     void read();
+    /** @brief Get the metrics to sample */
+    auto sources() const -> std::vector<sampler::Source>;
+    /** @brief Update a metric with a sample taken from sources() */
+    void apply(const sampler::Sample& sample);
     /** @brief Get the number of pending metrics */
     int getPendingConfigsCount()
     {
@@ -41,48 +53,65 @@ class HealthMetricCollection
     }
     /** @brief Create the pending metrics */
     void createPendingConfigs();
+    /** @brief Resolve the pending process configs and the BinaryName
+     *         patterns against the running processes */
+    void resolveProcesses(const sampler::processes_t& processes);
+    /** @brief Apply new configs, only touching added, removed or changed
+     *         metrics */
+    void reconfigure(const configs_t& configList);
+    /** @brief Replace the BMC inventory paths of all metrics, including
+     *         the ones created later */
+    void setBmcPaths(const MetricIntf::paths_t& paths);
 
   private:
     using map_t = std::unordered_map<std::string,
                                      std::unique_ptr<MetricIntf::HealthMetric>>;
-    using time_map_t = std::unordered_map<MetricIntf::SubType, uint64_t>;
     /** @brief Create a new health metric collection object */
     void create(const MetricIntf::paths_t& bmcPaths);
     /** @brief Create the health metric collection object for process cpu/memory
      * type */
     void createProcessMetric(const MetricIntf::paths_t& bmcPaths);
-    /** @brief Read the CPU */
-    auto readCPU() -> bool;
-    /** @brief Read the memory */
-    auto readMemory() -> bool;
-    /** @brief Read the storage */
-    auto readStorage() -> bool;
-    /** @brief Read the eMMC health */
-    auto readEMMC() -> bool;
-    /** @brief read process cpu usage*/
-    auto readProcessCPU() -> bool;
-    /** @brief read process memory usage*/
-    auto readProcessMemory() -> bool;
-    /** @brief Calculate the total memory in KB */
-    long long calculateTotalMemory();
+    /** @brief Create the health metric object for a non-process config */
+    void createMetric(const ConfigIntf::HealthMetric& config,
+                      const MetricIntf::paths_t& bmcPaths);
+    /** @brief Replace storage configs with "Path": "auto" by one config per
+     *         writable mount */
+    auto expandConfigs(const configs_t& configList) -> configs_t;
+    /** @brief Get the object path of the metric of a config */
+    auto getPath(const ConfigIntf::HealthMetric& config) const -> std::string
+    {
+        return MetricIntf::HealthMetric::getPath(type, config.name,
+                                                 config.subType);
+    }
+    /** @brief Check if a config of the list has the given object path */
+    auto hasPath(const configs_t& list, const std::string& path) const -> bool
+    {
+        return std::ranges::any_of(list, [this, &path](const auto& config) {
+            return getPath(config) == path;
+        });
+    }
+    /** @brief Compile the BinaryName matchers of the process configs */
+    void compileMatchers();
+    /** @brief Handle a process metric which failed to read */
+    void removeProcess(const std::string& name);
+    /** @brief Remove the metrics created for a BinaryName pattern config */
+    void removeInstances(const std::string& configName);
     /** @brief D-Bus bus connection */
     sdbusplus::bus_t& bus;
     /** @brief Metric type */
     MetricIntf::Type type;
     /** @brief Health metric configs */
-    const configs_t& configs;
+    configs_t configs;
     /** @brief Map of health metrics by subtype */
     map_t metrics;
-    /** @brief Map for active time by subtype */
-    time_map_t preActiveTime;
-    /** @brief Map for total time by subtype */
-    time_map_t preTotalTime;
-    /** total number cpus*/
-    static int cpus;
-    /** @brief clock ticks per second */
-    static int hertz;
+    /** @brief Sampler for read() */
+    sampler::Sampler sampler;
     /** @brief data structure for storing pending Metrics*/
     std::set<std::string> pendingConfigs;
+    /** @brief BinaryName matchers by process config name */
+    std::unordered_map<std::string, pattern::Matcher> matchers;
+    /** @brief Pattern config name by the metric created for a process */
+    std::unordered_map<std::string, std::string> instances;
 
     MetricIntf::paths_t bmcPaths;
 };
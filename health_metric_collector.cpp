@@ -0,0 +1,103 @@
+#include "health_metric_collector.hpp"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+PHOSPHOR_LOG2_USING;
+
+namespace phosphor::health::metric::collector
+{
+
+Collector::Collector(std::chrono::milliseconds interval) :
+    interval(interval), eventFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+{
+    if (eventFd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "eventfd");
+    }
+    thread = std::jthread([this](std::stop_token stop) { run(stop); });
+}
+
+Collector::~Collector()
+{
+    thread.request_stop();
+    wakeup.notify_all();
+    thread.join();
+    close(eventFd);
+}
+
+void Collector::publish(Plan newPlan)
+{
+    auto current = plan.load(std::memory_order_acquire);
+    if (current && *current == newPlan)
+    {
+        return;
+    }
+    plan.store(std::make_shared<const Plan>(std::move(newPlan)),
+               std::memory_order_release);
+    if (!current)
+    {
+        std::lock_guard lock(mutex);
+        wakeup.notify_all();
+    }
+}
+
+auto Collector::drain() -> std::vector<Batch>
+{
+    // Reset the eventfd before taking the batches, so that a batch pushed
+    // meanwhile wakes up the consumer again
+    eventfd_t count = 0;
+    eventfd_read(eventFd, &count);
+
+    std::vector<Batch> batches;
+    Batch batch;
+    while (ring.pop(batch))
+    {
+        batches.emplace_back(std::move(batch));
+    }
+    return batches;
+}
+
+void Collector::run(std::stop_token stop)
+{
+    {
+        std::unique_lock lock(mutex);
+        if (!wakeup.wait(lock, stop, [this] {
+                return plan.load(std::memory_order_acquire) != nullptr;
+            }))
+        {
+            return;
+        }
+    }
+
+    while (!stop.stop_requested())
+    {
+        auto current = plan.load(std::memory_order_acquire);
+
+        Batch batch;
+        batch.samples = sampler.read(current->sources);
+        if (current->listProcesses)
+        {
+            batch.processes = sampler::listProcesses();
+        }
+        if (ring.push(std::move(batch)))
+        {
+            eventfd_write(eventFd, 1);
+        }
+        else
+        {
+            warning("Health metric batches are not consumed, dropping a tick");
+        }
+
+        std::unique_lock lock(mutex);
+        wakeup.wait_for(lock, stop, interval, [] { return false; });
+    }
+}
+
+} // namespace phosphor::health::metric::collector
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "health_metric_sampler.hpp"
+#include "health_ring.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace phosphor::health::metric::collector
+{
+
+using ring::Ring;
+
+/** @brief What the collector samples on every tick */
+struct Plan
+{
+    /** @brief Metrics to sample */
+    std::vector<sampler::Source> sources;
+    /** @brief List the processes, to resolve pending process metrics */
+    bool listProcesses = false;
+
+    auto operator==(const Plan&) const -> bool = default;
+};
+
+/** @brief Result of one collection tick */
+struct Batch
+{
+    /** @brief Sampled values, in plan order */
+    std::vector<sampler::Sample> samples;
+    /** @brief Running processes, if requested by the plan */
+    std::optional<sampler::processes_t> processes;
+};
+
+/** @class Collector
+ *  @brief Samples the metrics on a dedicated thread
+ *
+ *  The D-Bus thread publishes the plan of metrics to sample and consumes the
+ *  resulting batches, so that slow reads from /proc or the filesystems never
+ *  delay D-Bus requests. Batches are handed over through a lock-free ring,
+ *  and an eventfd becomes readable whenever a batch is ready.
+ */
+class Collector
+{
+  public:
+    Collector() = delete;
+    Collector(const Collector&) = delete;
+    Collector& operator=(const Collector&) = delete;
+    Collector(Collector&&) = delete;
+    Collector& operator=(Collector&&) = delete;
+
+    /** @brief Start the collector thread, which waits for the first plan */
+    explicit Collector(std::chrono::milliseconds interval);
+    ~Collector();
+
+    /** @brief Replace the plan, used from the next tick on
+     *
+     *  The first plan starts sampling right away.
+     */
+    void publish(Plan newPlan);
+    /** @brief File descriptor which is readable when batches are ready */
+    auto getFd() const -> int
+    {
+        return eventFd;
+    }
+    /** @brief Take all ready batches, oldest first */
+    auto drain() -> std::vector<Batch>;
+
+  private:
+    /** @brief Collector thread */
+    void run(std::stop_token stop);
+
+    /** @brief Batches in flight, ticks are dropped while it is full */
+    static constexpr size_t ringSize = 4;
+
+    /** @brief Time between two ticks */
+    std::chrono::milliseconds interval;
+    /** @brief Current plan, replaced by the D-Bus thread */
+    std::atomic<std::shared_ptr<const Plan>> plan;
+    /** @brief Batches handed over to the D-Bus thread */
+    Ring<Batch, ringSize> ring;
+    /** @brief Wakes up the D-Bus thread */
+    int eventFd = -1;
+    /** @brief Sampler, only used by the collector thread */
+    sampler::Sampler sampler;
+    /** @brief Wakes up the collector thread for the first plan or to stop */
+    std::mutex mutex;
+    std::condition_variable_any wakeup;
+    /** @brief Collector thread, started last */
+    std::jthread thread;
+};
+
+} // namespace phosphor::health::metric::collector
@@ -2,12 +2,23 @@
 
 #include "health_metric_config.hpp"
 
+#include "default_health_metric_config.hpp"
+#include "health_metric_config_cache.hpp"
+#include "health_metric_config_defaults.hpp"
+
 #include <nlohmann/json.hpp>
 #include <phosphor-logging/lg2.hpp>
 
+#include <chrono>
 #include <cmath>
+#include <filesystem>
 #include <fstream>
+#include <iterator>
+#include <optional>
 #include <ranges>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -21,8 +32,10 @@ namespace config
 
 using json = nlohmann::json;
 
-// Default health metric config
-extern json defaultHealthMetricConfig;
+// Binary caches of the parsed configs, in cacheDirectory
+static constexpr auto healthConfigCacheFile = "health_config.cache";
+static constexpr auto serviceConfigCacheFile = "service_config.cache";
+static std::string cacheDirectory = HEALTH_CONFIG_CACHE_DIR;
 
 // Valid thresholds from config
 static const auto validThresholdTypesWithBound =
@@ -42,39 +55,25 @@ static const auto validThresholdTypes =
         {"Critical", ThresholdIntf::Type::Critical},
         {"Warning", ThresholdIntf::Type::Warning}};
 
-// Valid metrics from config
-static const auto validTypes = std::unordered_map<std::string, Type>{
-    {"CPU", Type::cpu},
-    {"Memory", Type::memory},
-    {"Storage", Type::storage},
-    {"Inode", Type::inode},
-    {"EMMC", Type::emmc},
-    {"ProcessCPU", Type::processCPU},
-    {"ProcessMemory", Type::processMemory}};
-
-// Valid submetrics from config
-static const auto validSubTypes = std::unordered_map<std::string, SubType>{
-    {"CPU", SubType::cpuTotal},
-    {"CPU_User", SubType::cpuUser},
-    {"CPU_Kernel", SubType::cpuKernel},
-    {"CPU_Processes", SubType::cpuProcesses},
-    {"Memory", SubType::memoryTotal},
-    {"Memory_Free", SubType::memoryFree},
-    {"Memory_Available", SubType::memoryAvailable},
-    {"Memory_Shared", SubType::memoryShared},
-    {"Memory_Buffered_And_Cached", SubType::memoryBufferedAndCached},
-    {"Memory_Processes", SubType::memoryProcesses},
-    {"Storage_RW", SubType::NA},
-    {"Storage_TMP", SubType::NA},
-    {"EMMC_Lifetime", SubType::emmcLifetime},
-    {"EMMC_Blocks", SubType::emmcBlocks}};
-
 /** Deserialize a Threshold from JSON. */
 void from_json(const json& j, Threshold& self)
 {
     self.value = j.value("Value", 100.0);
     self.log = j.value("Log", false);
     self.target = j.value("Target", Threshold::defaults::target);
+    self.deassertHysteresis = j.value("Deassert_hysteresis",
+                                      Threshold::defaults::deassertHysteresis);
+    self.holdTime = std::chrono::seconds(j.value(
+        "Hold_time", Threshold::defaults::holdTime.count()));
+    self.flapCount = j.value("Flap_count",
+                             size_t(Threshold::defaults::flapCount));
+    self.flapWindow = std::chrono::seconds(j.value(
+        "Flap_window", Threshold::defaults::flapWindow.count()));
+    auto rateLimit = j.value("Rate_limit", json::object());
+    self.rateLimitBurst = rateLimit.value(
+        "Burst", size_t(Threshold::defaults::rateLimitBurst));
+    self.rateLimitPeriod = std::chrono::seconds(rateLimit.value(
+        "Period", Threshold::defaults::rateLimitPeriod.count()));
 }
 
 /** Deserialize a HealthMetric from JSON. */
@@ -118,7 +117,7 @@ void from_json(const json& j, HealthMetric& self)
     }
 }
 
-json parseConfigFile(std::string configFile)
+std::string readConfigFile(const std::string& configFile)
 {
     std::ifstream jsonFile(configFile);
     if (!jsonFile.is_open())
@@ -126,10 +125,20 @@ json parseConfigFile(std::string configFile)
         info("config JSON file not found: {PATH}", "PATH", configFile);
         return {};
     }
+    return {std::istreambuf_iterator<char>(jsonFile),
+            std::istreambuf_iterator<char>()};
+}
+
+json parseConfig(const std::string& configText, const std::string& configFile)
+{
+    if (configText.empty())
+    {
+        return {};
+    }
 
     try
     {
-        return json::parse(jsonFile, nullptr, true);
+        return json::parse(configText, nullptr, true);
     }
     catch (const json::parse_error& e)
     {
@@ -140,6 +149,26 @@ json parseConfigFile(std::string configFile)
     return {};
 }
 
+/** Parse a platform config, unlike parseConfig() a syntax error throws. */
+json parsePlatformConfig(const std::string& configText,
+                         const std::string& configFile)
+{
+    if (configText.empty())
+    {
+        return {};
+    }
+
+    try
+    {
+        return json::parse(configText, nullptr, true);
+    }
+    catch (const json::parse_error& e)
+    {
+        throw std::invalid_argument("Invalid JSON in " + configFile + ": " +
+                                    e.what());
+    }
+}
+
 void printConfig(HealthMetric::map_t& configs)
 {
     for (auto& [type, configList] : configs)
@@ -165,148 +194,383 @@ void printConfig(HealthMetric::map_t& configs)
     }
 }
 
-auto getHealthMetricConfigs() -> HealthMetric::map_t
+/** Convert a built-in default metric to its config. */
+auto toConfig(const DefaultMetric& metric) -> HealthMetric
 {
-    json mergedConfig(defaultHealthMetricConfig);
+    HealthMetric config;
+    config.name = metric.name;
+    config.binaryName = metric.binaryName;
+    config.frequency = metric.frequency;
+    config.subType = metric.subType;
+    config.windowSize = metric.windowSize;
+    config.hysteresis = metric.hysteresis;
+    config.path = metric.path;
+    for (const auto& threshold :
+         std::span(metric.thresholds).first(metric.thresholdCount))
+    {
+        config.thresholds.emplace(
+            std::make_tuple(threshold.type, threshold.bound),
+            Threshold{.value = threshold.value,
+                      .log = threshold.log,
+                      .target = std::string(threshold.target),
+                      .deassertHysteresis = threshold.deassertHysteresis,
+                      .holdTime = threshold.holdTime,
+                      .flapCount = threshold.flapCount,
+                      .flapWindow = threshold.flapWindow,
+                      .rateLimitBurst = threshold.rateLimitBurst,
+                      .rateLimitPeriod = threshold.rateLimitPeriod});
+    }
+    return config;
+}
 
-    if (auto platformConfig = parseConfigFile(HEALTH_CONFIG_FILE);
-        !platformConfig.empty())
+/** Apply a JSON merge patch of a Threshold, null resets to the default. */
+void mergeThreshold(const json& j, Threshold& self)
+{
+    if (auto value = j.find("Value"); value != j.end())
+    {
+        self.value = value->is_null() ? 100.0 : value->get<double>();
+    }
+    if (auto log = j.find("Log"); log != j.end())
+    {
+        self.log = !log->is_null() && log->get<bool>();
+    }
+    auto merge = [&j](const char* key, auto& field, auto defaultValue) {
+        if (auto value = j.find(key); value != j.end())
+        {
+            field = value->is_null()
+                        ? defaultValue
+                        : value->get<std::remove_cvref_t<decltype(field)>>();
+        }
+    };
+    merge("Target", self.target, std::string(Threshold::defaults::target));
+    merge("Deassert_hysteresis", self.deassertHysteresis,
+          Threshold::defaults::deassertHysteresis);
+    merge("Flap_count", self.flapCount,
+          size_t(Threshold::defaults::flapCount));
+    auto seconds = [&j](const char* key, std::chrono::seconds& field,
+                        std::chrono::seconds defaultValue) {
+        if (auto value = j.find(key); value != j.end())
+        {
+            field = value->is_null()
+                        ? defaultValue
+                        : std::chrono::seconds(value->get<int64_t>());
+        }
+    };
+    seconds("Hold_time", self.holdTime, Threshold::defaults::holdTime);
+    seconds("Flap_window", self.flapWindow, Threshold::defaults::flapWindow);
+    if (auto rateLimit = j.find("Rate_limit"); rateLimit != j.end())
+    {
+        if (rateLimit->is_null())
+        {
+            self.rateLimitBurst = Threshold::defaults::rateLimitBurst;
+            self.rateLimitPeriod = Threshold::defaults::rateLimitPeriod;
+        }
+        else
+        {
+            auto burst = rateLimit->find("Burst");
+            if (burst != rateLimit->end())
+            {
+                self.rateLimitBurst = burst->is_null()
+                                          ? Threshold::defaults::rateLimitBurst
+                                          : burst->get<size_t>();
+            }
+            auto period = rateLimit->find("Period");
+            if (period != rateLimit->end())
+            {
+                self.rateLimitPeriod =
+                    period->is_null()
+                        ? Threshold::defaults::rateLimitPeriod
+                        : std::chrono::seconds(period->get<int64_t>());
+            }
+        }
+    }
+    if (!std::isfinite(self.value))
     {
-        mergedConfig.merge_patch(platformConfig);
+        throw std::invalid_argument("Invalid threshold value");
+    }
+}
+
+/** Apply a JSON merge patch of a HealthMetric, null resets to the default. */
+void mergeHealthMetric(const json& j, HealthMetric& self)
+{
+    auto merge = [&j](const char* key, auto& field, auto defaultValue) {
+        if (auto value = j.find(key); value != j.end())
+        {
+            field = value->is_null()
+                        ? defaultValue
+                        : value->get<std::remove_cvref_t<decltype(field)>>();
+        }
+    };
+    merge("Window_size", self.windowSize,
+          size_t(HealthMetric::defaults::windowSize));
+    merge("Hysteresis", self.hysteresis, HealthMetric::defaults::hysteresis);
+    merge("Path", self.path, std::string());
+    merge("BinaryName", self.binaryName, std::string());
+    merge("Frequency", self.frequency,
+          uint16_t(HealthMetric::defaults::frequency));
+
+    auto thresholds = j.find("Threshold");
+    if (thresholds == j.end())
+    {
+        return;
+    }
+    if (thresholds->is_null())
+    {
+        self.thresholds.clear();
+        return;
+    }
+
+    for (auto& [key, value] : thresholds->items())
+    {
+        if (!validThresholdTypesWithBound.contains(key))
+        {
+            warning("Invalid ThresholdType: {TYPE}", "TYPE", key);
+            continue;
+        }
+
+        static constexpr auto keyDelimiter = "_";
+        std::string typeStr = key.substr(0, key.find_first_of(keyDelimiter));
+        std::string boundStr = key.substr(key.find_last_of(keyDelimiter) + 1,
+                                          key.length());
+        auto thresholdKey = std::make_tuple(validThresholdTypes.at(typeStr),
+                                            validThresholdBounds.at(boundStr));
+        if (value.is_null())
+        {
+            self.thresholds.erase(thresholdKey);
+            continue;
+        }
+
+        auto [threshold, added] = self.thresholds.try_emplace(
+            thresholdKey, json::object().template get<Threshold>());
+        mergeThreshold(value, threshold->second);
+    }
+}
+
+auto parseHealthMetricConfigs(const std::string& platformText)
+    -> HealthMetric::map_t
+{
+    // Built-in defaults are compiled in, the platform JSON is only parsed for
+    // overrides and applied with JSON merge patch semantics.
+    std::map<std::string, HealthMetric, std::less<>> mergedConfig;
+    for (const auto& metric : defaultHealthMetrics)
+    {
+        mergedConfig.emplace(metric.name, toConfig(metric));
+    }
+
+    if (auto platformConfig = parsePlatformConfig(platformText,
+                                                  HEALTH_CONFIG_FILE);
+        platformConfig.is_object())
+    {
+        for (auto& [name, metric] : platformConfig.items())
+        {
+            if (!metric.is_object())
+            {
+                mergedConfig.erase(name);
+                continue;
+            }
+
+            auto [config, added] = mergedConfig.try_emplace(
+                name, json::object().template get<HealthMetric>());
+            if (added)
+            {
+                config->second.name = name;
+                auto subType = findByName(validSubTypes, name);
+                config->second.subType =
+                    (subType != nullptr ? subType->second : SubType::NA);
+            }
+            mergeHealthMetric(metric, config->second);
+        }
     }
 
     HealthMetric::map_t configs = {};
-    for (auto& [name, metric] : mergedConfig.items())
+    for (auto& [name, config] : mergedConfig)
     {
         static constexpr auto nameDelimiter = "_";
         std::string typeStr = name.substr(0, name.find_first_of(nameDelimiter));
 
-        auto type = validTypes.find(typeStr);
-        if (type == validTypes.end())
+        auto type = findByName(validTypes, typeStr);
+        if (type == nullptr)
         {
             warning("Invalid metric type: {TYPE}", "TYPE", typeStr);
             continue;
         }
 
-        auto config = metric.template get<HealthMetric>();
-        config.name = name;
-
-        auto subType = validSubTypes.find(name);
-        config.subType = (subType != validSubTypes.end() ? subType->second
-                                                         : SubType::NA);
-
         configs[type->second].emplace_back(std::move(config));
     }
-    printConfig(configs);
     return configs;
 }
 
-json defaultHealthMetricConfig = R"({
-    "CPU": {
-        "Threshold": {
-            "Critical_Upper": {
-                "Value": 90.0,
-                "Log": true,
-                "Target": ""
-            },
-            "Warning_Upper": {
-                "Value": 80.0,
-                "Log": false,
-                "Target": ""
-            }
-        }
-    },
-    "CPU_User": {
-    },
-    "CPU_Kernel": {
-    },
-    "Memory": {
-    },
-    "Memory_Available": {
-        "Threshold": {
-            "Critical_Lower": {
-                "Value": 15.0,
-                "Log": true,
-                "Target": ""
-            }
-        }
-    },
-    "Memory_Free": {
-    },
-    "Memory_Shared": {
-        "Threshold": {
-            "Critical_Upper": {
-                "Value": 85.0,
-                "Log": true,
-                "Target": ""
-            }
+/** Load configs from the cache, or parse and cache them if stale. */
+auto loadConfigs(std::string_view cacheName,
+                 std::initializer_list<std::string_view> sources,
+                 std::function<HealthMetric::map_t()> parse)
+    -> HealthMetric::map_t
+{
+    auto start = std::chrono::steady_clock::now();
+    auto cacheKey = cache::key(sources);
+
+    std::optional<HealthMetric::map_t> configs;
+    auto cacheFile = cacheDirectory + "/" + std::string(cacheName);
+    if (!cacheDirectory.empty())
+    {
+        configs = cache::load(cacheFile, cacheKey);
+    }
+    auto cached = configs.has_value();
+    if (!cached)
+    {
+        configs = parse();
+        printConfig(*configs);
+        if (!cacheDirectory.empty())
+        {
+            cache::store(cacheFile, cacheKey, *configs);
         }
-    },
-    "Memory_Buffered_And_Cached": {
-    },
-    "Storage_RW": {
-        "Path": "/run/initramfs/rw",
-        "Threshold": {
-            "Critical_Lower": {
-                "Value": 15.0,
-                "Log": true,
-                "Target": ""
-            }
+    }
+
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    info("Loaded configs (cached: {CACHED}) in {DURATION}us", "CACHED",
+         cached, "DURATION", duration.count());
+    return *configs;
+}
+
+/** Read the runtime tuning persisted by saveOverride(). */
+json readOverrides()
+{
+    if (std::string_view(THRESHOLD_OVERRIDE_FILE).empty())
+    {
+        return {};
+    }
+    return parseConfig(readConfigFile(THRESHOLD_OVERRIDE_FILE),
+                       THRESHOLD_OVERRIDE_FILE);
+}
+
+/** Apply the overrides saved under the names of the configs. */
+void applyOverrides(const json& overrides, std::span<HealthMetric> configs)
+{
+    if (!overrides.is_object())
+    {
+        return;
+    }
+
+    for (auto& config : configs)
+    {
+        auto entry = overrides.find(config.name);
+        if (entry == overrides.end() || !entry->is_object())
+        {
+            continue;
         }
-    },
-    "Storage_TMP": {
-        "Path": "/tmp",
-        "Threshold": {
-            "Critical_Lower": {
-                "Value": 15.0,
-                "Log": true,
-                "Target": ""
-            }
+        try
+        {
+            mergeHealthMetric(*entry, config);
         }
-    },
-    "EMMC_Lifetime": {
-        "Path": "/sys/block/mmcblk0/device/life_time",
-        "Threshold": {
-            "Critical_Upper": {
-                "Value": 9,
-                "Log": true,
-                "Target": ""
-            },
-            "Warning_Upper": {
-                "Value": 8,
-                "Log": true,
-                "Target": ""
-            }
+        catch (const std::exception& e)
+        {
+            error("Invalid override for {NAME}: {ERROR}", "NAME", config.name,
+                  "ERROR", e);
         }
-    },
-    "EMMC_Blocks": {
-        "Path": "/sys/block/mmcblk0/device/pre_eol_info",
-        "Threshold": {
-            "Critical_Upper": {
-                "Value": 2,
-                "Log": true,
-                "Target": ""
-            },
-            "Warning_Upper": {
-                "Value": 1,
-                "Log": true,
-                "Target": ""
-            }
+    }
+}
+
+void applyOverrides(std::span<HealthMetric> configs)
+{
+    applyOverrides(readOverrides(), configs);
+}
+
+/** Apply the overrides to the configs of all types. */
+void applyOverrides(HealthMetric::map_t& configs)
+{
+    auto overrides = readOverrides();
+    for (auto& [type, configList] : configs)
+    {
+        applyOverrides(overrides, configList);
+    }
+}
+
+auto saveOverride(const HealthMetric& config) -> bool
+{
+    std::string file = THRESHOLD_OVERRIDE_FILE;
+    if (file.empty())
+    {
+        return true;
+    }
+
+    auto overrides = parseConfig(readConfigFile(file), file);
+    if (!overrides.is_object())
+    {
+        overrides = json::object();
+    }
+    auto& entry = overrides[config.name];
+    entry["Window_size"] = config.windowSize;
+    entry["Hysteresis"] = config.hysteresis;
+    for (const auto& [key, threshold] : config.thresholds)
+    {
+        auto second = [](const auto& p) { return p.second; };
+        auto type = std::ranges::find(validThresholdTypes,
+                                      get<ThresholdIntf::Type>(key), second);
+        auto bound = std::ranges::find(validThresholdBounds,
+                                       get<ThresholdIntf::Bound>(key), second);
+        entry["Threshold"][type->first + "_" + bound->first]["Value"] =
+            threshold.value;
+    }
+
+    std::error_code ec;
+    auto path = std::filesystem::path(file);
+    std::filesystem::create_directories(path.parent_path(), ec);
+    auto tmpFile = file + ".tmp";
+    {
+        std::ofstream out(tmpFile, std::ios::trunc);
+        out << overrides.dump(4);
+        if (!out.good())
+        {
+            error("Failed to write {PATH}", "PATH", tmpFile);
+            return false;
         }
     }
-})"_json;
+    std::filesystem::rename(tmpFile, path, ec);
+    if (ec)
+    {
+        error("Failed to write {PATH}: {ERROR}", "PATH", file, "ERROR",
+              ec.message());
+        return false;
+    }
+    return true;
+}
 
-auto getServiceMetricConfigs() -> HealthMetric::map_t
+void setCacheDirectory(const std::string& directory)
 {
-    auto platformConfig = parseConfigFile(SERVICE_HEALTH_CONFIG_FILE);
+    cacheDirectory = directory;
+}
+
+auto getHealthMetricConfigs() -> HealthMetric::map_t
+{
+    auto platformText = readConfigFile(HEALTH_CONFIG_FILE);
+    auto configs = loadConfigs(
+        healthConfigCacheFile, {defaultHealthMetricDigest, platformText},
+        [&platformText]() { return parseHealthMetricConfigs(platformText); });
+    applyOverrides(configs);
+    return configs;
+}
+
+auto getDefaultHealthMetricConfigs() -> HealthMetric::map_t
+{
+    auto configs = parseHealthMetricConfigs("");
+    applyOverrides(configs);
+    return configs;
+}
+
+auto parseServiceMetricConfigs(const std::string& platformText)
+    -> HealthMetric::map_t
+{
+    auto platformConfig = parsePlatformConfig(platformText,
+                                              SERVICE_HEALTH_CONFIG_FILE);
 
     HealthMetric::map_t configs = {};
     for (auto& [name, metric] : platformConfig.items())
     {
         static constexpr auto nameDelimiter = "_";
         std::string typeStr = name.substr(0, name.find_first_of(nameDelimiter));
-        auto type = validTypes.find(typeStr);
-        if (type == validTypes.end())
+        auto type = findByName(validTypes, typeStr);
+        if (type == nullptr)
         {
             warning("Invalid metric type: {TYPE}", "TYPE", typeStr);
             continue;
@@ -323,13 +587,21 @@ auto getServiceMetricConfigs() -> HealthMetric::map_t
         {
             subType = "Memory_Processes";
         }
-        auto var = validSubTypes.find(subType);
-        config.subType = (var != validSubTypes.end() ? var->second
-                                                     : SubType::NA);
+        auto var = findByName(validSubTypes, subType);
+        config.subType = (var != nullptr ? var->second : SubType::NA);
 
         configs[type->second].emplace_back(std::move(config));
     }
-    printConfig(configs);
+    return configs;
+}
+
+auto getServiceMetricConfigs() -> HealthMetric::map_t
+{
+    auto platformText = readConfigFile(SERVICE_HEALTH_CONFIG_FILE);
+    auto configs = loadConfigs(
+        serviceConfigCacheFile, {platformText},
+        [&platformText]() { return parseServiceMetricConfigs(platformText); });
+    applyOverrides(configs);
     return configs;
 }
 
@@ -343,7 +615,7 @@ auto reverse_map_search(const auto& m, auto v)
             m, [=](const auto& p) { return p.second == v; });
         match != std::end(m))
     {
-        return match->first;
+        return std::string(match->first);
     }
     return std::format("Enum({})", std::to_underlying(v));
 }
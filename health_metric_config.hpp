@@ -6,6 +6,7 @@
 #include <chrono>
 #include <limits>
 #include <map>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -61,15 +62,39 @@ struct Threshold
     double value = defaults::value;
     bool log = false;
     std::string target = defaults::target;
+    /** @brief Percent by which the value must clear the limit to deassert */
+    double deassertHysteresis = defaults::deassertHysteresis;
+    /** @brief Minimum time an assertion is held before it may deassert */
+    std::chrono::seconds holdTime = defaults::holdTime;
+    /** @brief Number of transitions within flapWindow after which the
+     *         threshold is considered flapping, 0 disables flap detection */
+    size_t flapCount = defaults::flapCount;
+    /** @brief Window for flap detection, a flapping threshold is held
+     *         asserted until the value stayed clear for this long */
+    std::chrono::seconds flapWindow = defaults::flapWindow;
+    /** @brief Number of actions, i.e. log entries and target starts, allowed
+     *         back to back */
+    size_t rateLimitBurst = defaults::rateLimitBurst;
+    /** @brief Time for one action to be allowed again, 0 for the build
+     *         time log rate limit */
+    std::chrono::seconds rateLimitPeriod = defaults::rateLimitPeriod;
 
     using map_t =
         std::map<std::tuple<ThresholdIntf::Type, ThresholdIntf::Bound>,
                  Threshold>;
 
+    bool operator==(const Threshold&) const = default;
+
     struct defaults
     {
         static constexpr auto value = std::numeric_limits<double>::quiet_NaN();
         static constexpr auto target = "";
+        static constexpr auto deassertHysteresis = 0.0;
+        static constexpr auto holdTime = 0s;
+        static constexpr auto flapCount = 0;
+        static constexpr auto flapWindow = 300s;
+        static constexpr auto rateLimitBurst = 1;
+        static constexpr auto rateLimitPeriod = 0s;
     };
 };
 
@@ -94,6 +119,8 @@ struct HealthMetric
 
     using map_t = std::map<Type, std::vector<HealthMetric>>;
 
+    bool operator==(const HealthMetric&) const = default;
+
     struct defaults
     {
         static constexpr auto windowSize = 12;
@@ -103,10 +130,40 @@ struct HealthMetric
     };
 };
 
-/** @brief Get the health metric configs. */
+/** @brief Parse the health metric configs, the built-in defaults overridden
+ *         by the platform config JSON text.
+ *
+ *  Throws if the text is not valid JSON or has invalid values.
+ */
+auto parseHealthMetricConfigs(const std::string& platformText)
+    -> HealthMetric::map_t;
+
+/** @brief Persist the runtime tuning of a metric to the override file.
+ *
+ *  The override file uses the health config JSON format and is applied on
+ *  top of the health and service metric configs. Instances of pattern
+ *  configs are saved under their own name. Returns true if persisting is
+ *  disabled at build time or succeeded.
+ */
+auto saveOverride(const HealthMetric& config) -> bool;
+
+/** @brief Apply the runtime tuning persisted by saveOverride() to configs
+ *         named after loading, i.e. the instances of pattern configs. */
+void applyOverrides(std::span<HealthMetric> configs);
+
+/** @brief Set the directory of the parsed config caches, empty to always
+ *         parse, used by CI unit tests */
+void setCacheDirectory(const std::string& directory);
+
+/** @brief Get the health metric configs, throws if the platform config is
+ *         invalid. */
 auto getHealthMetricConfigs() -> HealthMetric::map_t;
 
-/** @brief Get the Service metric configs. */
+/** @brief Get the built-in health metric configs, used instead of an
+ *         invalid platform config. */
+auto getDefaultHealthMetricConfigs() -> HealthMetric::map_t;
+
+/** @brief Get the Service metric configs, throws if the config is invalid. */
 auto getServiceMetricConfigs() -> HealthMetric::map_t;
 
 } // namespace config
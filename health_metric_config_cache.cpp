@@ -0,0 +1,223 @@
+#include "health_metric_config_cache.hpp"
+
+#include "health_metric_serialize.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+PHOSPHOR_LOG2_USING;
+
+namespace phosphor::health::metric::config::cache
+{
+
+/*
+ * Cache layout, in host byte order:
+ *
+ *   u32 magic, u32 version, u64 key, u32 metric count
+ *   per metric:
+ *     u8 type, u8 subType, u32 windowSize, f64 hysteresis, u16 frequency,
+ *     str name, str binaryName, str path, u8 threshold count
+ *     per threshold:
+ *       u8 type, u8 bound, f64 value, u8 log, str target,
+ *       f64 deassertHysteresis, u32 holdTime, u32 flapCount, u32 flapWindow,
+ *       u32 rateLimitBurst, u32 rateLimitPeriod
+ *
+ * where str is a u16 length followed by the characters.
+ */
+static constexpr uint32_t magic = 0x48434643; // "CFCH"
+static constexpr uint32_t version = 3;
+
+auto key(std::initializer_list<std::string_view> sources) -> uint64_t
+{
+    // FNV-1a over the sources, each followed by its length so that moving
+    // bytes between sources changes the key.
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        auto bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+    };
+    mix(&version, sizeof(version));
+    for (const auto& source : sources)
+    {
+        uint64_t size = source.size();
+        mix(source.data(), source.size());
+        mix(&size, sizeof(size));
+    }
+    return hash;
+}
+
+namespace
+{
+
+using serialize::Reader;
+using serialize::Writer;
+
+auto decode(Reader& reader, uint64_t key) -> std::optional<HealthMetric::map_t>
+{
+    uint32_t fileMagic = 0;
+    uint32_t fileVersion = 0;
+    uint64_t fileKey = 0;
+    uint32_t count = 0;
+    if (!reader.get(fileMagic) || fileMagic != magic ||
+        !reader.get(fileVersion) || fileVersion != version ||
+        !reader.get(fileKey) || fileKey != key || !reader.get(count))
+    {
+        return std::nullopt;
+    }
+
+    HealthMetric::map_t configs;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint8_t type = 0;
+        uint8_t subType = 0;
+        uint32_t windowSize = 0;
+        uint8_t thresholdCount = 0;
+        HealthMetric config;
+        if (!reader.get(type) || !reader.get(subType) ||
+            !reader.get(windowSize) || !reader.get(config.hysteresis) ||
+            !reader.get(config.frequency) || !reader.get(config.name) ||
+            !reader.get(config.binaryName) || !reader.get(config.path) ||
+            !reader.get(thresholdCount))
+        {
+            return std::nullopt;
+        }
+        config.subType = static_cast<SubType>(subType);
+        config.windowSize = windowSize;
+
+        for (uint8_t j = 0; j < thresholdCount; j++)
+        {
+            uint8_t thresholdType = 0;
+            uint8_t bound = 0;
+            uint8_t log = 0;
+            uint32_t holdTime = 0;
+            uint32_t flapCount = 0;
+            uint32_t flapWindow = 0;
+            uint32_t rateLimitBurst = 0;
+            uint32_t rateLimitPeriod = 0;
+            Threshold threshold;
+            if (!reader.get(thresholdType) || !reader.get(bound) ||
+                !reader.get(threshold.value) || !reader.get(log) ||
+                !reader.get(threshold.target) ||
+                !reader.get(threshold.deassertHysteresis) ||
+                !reader.get(holdTime) || !reader.get(flapCount) ||
+                !reader.get(flapWindow) || !reader.get(rateLimitBurst) ||
+                !reader.get(rateLimitPeriod))
+            {
+                return std::nullopt;
+            }
+            threshold.log = (log != 0);
+            threshold.holdTime = std::chrono::seconds(holdTime);
+            threshold.flapCount = flapCount;
+            threshold.flapWindow = std::chrono::seconds(flapWindow);
+            threshold.rateLimitBurst = rateLimitBurst;
+            threshold.rateLimitPeriod = std::chrono::seconds(rateLimitPeriod);
+            config.thresholds.emplace(
+                std::make_tuple(
+                    static_cast<ThresholdIntf::Type>(thresholdType),
+                    static_cast<ThresholdIntf::Bound>(bound)),
+                std::move(threshold));
+        }
+        configs[static_cast<Type>(type)].emplace_back(std::move(config));
+    }
+
+    if (!reader.done())
+    {
+        return std::nullopt;
+    }
+    return configs;
+}
+
+} // namespace
+
+auto load(const std::string& cacheFile, uint64_t key)
+    -> std::optional<HealthMetric::map_t>
+{
+    auto fd = open(cacheFile.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return std::nullopt;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return std::nullopt;
+    }
+    auto size = static_cast<size_t>(st.st_size);
+    auto addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+    {
+        return std::nullopt;
+    }
+
+    Reader reader(static_cast<const char*>(addr), size);
+    auto configs = decode(reader, key);
+    munmap(addr, size);
+    return configs;
+}
+
+void store(const std::string& cacheFile, uint64_t key,
+           const HealthMetric::map_t& configs)
+{
+    Writer writer;
+    uint32_t count = 0;
+    for (const auto& [type, list] : configs)
+    {
+        count += list.size();
+    }
+    writer.put(magic);
+    writer.put(version);
+    writer.put(key);
+    writer.put(count);
+
+    for (const auto& [type, list] : configs)
+    {
+        for (const auto& config : list)
+        {
+            writer.put(static_cast<uint8_t>(type));
+            writer.put(static_cast<uint8_t>(config.subType));
+            writer.put(static_cast<uint32_t>(config.windowSize));
+            writer.put(config.hysteresis);
+            writer.put(config.frequency);
+            writer.put(config.name);
+            writer.put(config.binaryName);
+            writer.put(config.path);
+            writer.put(static_cast<uint8_t>(config.thresholds.size()));
+            for (const auto& [threshold, value] : config.thresholds)
+            {
+                writer.put(static_cast<uint8_t>(
+                    std::get<ThresholdIntf::Type>(threshold)));
+                writer.put(static_cast<uint8_t>(
+                    std::get<ThresholdIntf::Bound>(threshold)));
+                writer.put(value.value);
+                writer.put(static_cast<uint8_t>(value.log));
+                writer.put(value.target);
+                writer.put(value.deassertHysteresis);
+                writer.put(static_cast<uint32_t>(value.holdTime.count()));
+                writer.put(static_cast<uint32_t>(value.flapCount));
+                writer.put(static_cast<uint32_t>(value.flapWindow.count()));
+                writer.put(static_cast<uint32_t>(value.rateLimitBurst));
+                writer.put(
+                    static_cast<uint32_t>(value.rateLimitPeriod.count()));
+            }
+        }
+    }
+
+    if (auto ec = serialize::replaceFile(cacheFile, writer.buffer))
+    {
+        info("Unable to write config cache {PATH}: {ERROR}", "PATH", cacheFile,
+             "ERROR", ec.message());
+    }
+}
+
+} // namespace phosphor::health::metric::config::cache
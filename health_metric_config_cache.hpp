@@ -0,0 +1,24 @@
+#pragma once
+
+#include "health_metric_config.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace phosphor::health::metric::config::cache
+{
+
+/** @brief Compute the cache key for the given config sources */
+auto key(std::initializer_list<std::string_view> sources) -> uint64_t;
+
+/** @brief Load the configs from the cache file if it matches the key */
+auto load(const std::string& cacheFile, uint64_t key)
+    -> std::optional<HealthMetric::map_t>;
+
+/** @brief Store the configs into the cache file under the key */
+void store(const std::string& cacheFile, uint64_t key,
+           const HealthMetric::map_t& configs);
+
+} // namespace phosphor::health::metric::config::cache
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "health_metric_config.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace phosphor::health::metric::config
+{
+
+// Valid metrics from config
+inline constexpr auto validTypes =
+    std::to_array<std::pair<std::string_view, Type>>(
+        {{"CPU", Type::cpu},
+         {"Memory", Type::memory},
+         {"Storage", Type::storage},
+         {"Inode", Type::inode},
+         {"EMMC", Type::emmc},
+         {"ProcessCPU", Type::processCPU},
+         {"ProcessMemory", Type::processMemory}});
+
+// Valid submetrics from config
+inline constexpr auto validSubTypes =
+    std::to_array<std::pair<std::string_view, SubType>>(
+        {{"CPU", SubType::cpuTotal},
+         {"CPU_User", SubType::cpuUser},
+         {"CPU_Kernel", SubType::cpuKernel},
+         {"CPU_Processes", SubType::cpuProcesses},
+         {"Memory", SubType::memoryTotal},
+         {"Memory_Free", SubType::memoryFree},
+         {"Memory_Available", SubType::memoryAvailable},
+         {"Memory_Shared", SubType::memoryShared},
+         {"Memory_Buffered_And_Cached", SubType::memoryBufferedAndCached},
+         {"Memory_Processes", SubType::memoryProcesses},
+         {"Storage_RW", SubType::NA},
+         {"Storage_TMP", SubType::NA},
+         {"EMMC_Lifetime", SubType::emmcLifetime},
+         {"EMMC_Blocks", SubType::emmcBlocks}});
+
+/** @brief Find the entry for name in one of the tables above, or nullptr. */
+constexpr auto findByName(const auto& table, std::string_view name)
+    -> decltype(std::data(table))
+{
+    auto match = std::ranges::find_if(
+        table, [name](const auto& entry) { return entry.first == name; });
+    return match != std::end(table) ? &*match : nullptr;
+}
+
+/** @brief The type of a metric name, the prefix before the first '_'. */
+consteval auto metricType(std::string_view name) -> Type
+{
+    auto type = findByName(validTypes, name.substr(0, name.find('_')));
+    if (type == nullptr)
+    {
+        throw std::invalid_argument("Invalid metric type");
+    }
+    return type->second;
+}
+
+/** @brief The subtype of a metric name, NA if it has none. */
+consteval auto metricSubType(std::string_view name) -> SubType
+{
+    auto subType = findByName(validSubTypes, name);
+    return subType != nullptr ? subType->second : SubType::NA;
+}
+
+/** @brief A threshold of a built-in default metric. */
+struct DefaultThreshold
+{
+    ThresholdIntf::Type type;
+    ThresholdIntf::Bound bound;
+    double value;
+    bool log;
+    std::string_view target;
+    double deassertHysteresis;
+    std::chrono::seconds holdTime;
+    size_t flapCount;
+    std::chrono::seconds flapWindow;
+    size_t rateLimitBurst;
+    std::chrono::seconds rateLimitPeriod;
+};
+
+/** @brief A built-in default metric, generated from
+ *         default_bmc_health_config.json at build time.
+ */
+struct DefaultMetric
+{
+    std::string_view name;
+    Type type;
+    SubType subType;
+    size_t windowSize;
+    double hysteresis;
+    uint16_t frequency;
+    std::string_view path;
+    std::string_view binaryName;
+    size_t thresholdCount;
+    /** @brief Critical and Warning, each with a Lower and Upper bound */
+    std::array<DefaultThreshold, 4> thresholds;
+};
+
+} // namespace phosphor::health::metric::config
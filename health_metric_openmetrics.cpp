@@ -0,0 +1,362 @@
+#include "health_metric_openmetrics.hpp"
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+#include <sdbusplus/async/fdio.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <string_view>
+
+PHOSPHOR_LOG2_USING;
+
+namespace phosphor::health::metric::openmetrics
+{
+
+static constexpr auto valueFamily =
+    "# TYPE bmc_health_metric gauge\n"
+    "# HELP bmc_health_metric Current value of the BMC health metric.\n";
+static constexpr auto thresholdFamily =
+    "# TYPE bmc_health_threshold gauge\n"
+    "# HELP bmc_health_threshold Threshold value of the BMC health metric.\n";
+static constexpr auto assertedFamily =
+    "# TYPE bmc_health_threshold_asserted gauge\n"
+    "# HELP bmc_health_threshold_asserted Whether the threshold is asserted.\n";
+static constexpr auto eof = "# EOF\n";
+
+/** @brief Longest time given to a scraper to read the payload */
+static constexpr auto writeTimeout = std::chrono::seconds(5);
+/** @brief Interval between attempts to write the rest of a payload */
+static constexpr auto writeRetry = std::chrono::milliseconds(10);
+
+static auto to_label(ThresholdIntf::Type type) -> const char*
+{
+    switch (type)
+    {
+        case ThresholdIntf::Type::HardShutdown:
+            return "HardShutdown";
+        case ThresholdIntf::Type::SoftShutdown:
+            return "SoftShutdown";
+        case ThresholdIntf::Type::PerformanceLoss:
+            return "PerformanceLoss";
+        case ThresholdIntf::Type::Critical:
+            return "Critical";
+        case ThresholdIntf::Type::Warning:
+            return "Warning";
+        default:
+            return "Unknown";
+    }
+}
+
+static auto to_label(ThresholdIntf::Bound bound) -> const char*
+{
+    return (bound == ThresholdIntf::Bound::Lower) ? "Lower" : "Upper";
+}
+
+static auto to_number(double value) -> std::string
+{
+    if (std::isnan(value))
+    {
+        return "NaN";
+    }
+    if (std::isinf(value))
+    {
+        return (value > 0) ? "+Inf" : "-Inf";
+    }
+    return std::format("{}", value);
+}
+
+/** @brief Escape a label value, names come straight from the config */
+static auto escapeLabel(std::string_view value) -> std::string
+{
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (auto c : value)
+    {
+        switch (c)
+        {
+            case '\\':
+                escaped += "\\\\";
+                break;
+            case '"':
+                escaped += "\\\"";
+                break;
+            case '\n':
+                escaped += "\\n";
+                break;
+            default:
+                escaped += c;
+        }
+    }
+    return escaped;
+}
+
+/** @brief Compare two values, NaN never compares equal but is unchanged */
+static auto sameNumber(double a, double b) -> bool
+{
+    return (a == b) || (std::isnan(a) && std::isnan(b));
+}
+
+/** @brief Compare two threshold maps, the values are NaN until the first
+ *         sample */
+static auto sameThresholds(
+    const std::map<ThresholdIntf::Type, std::map<ThresholdIntf::Bound, double>>&
+        a,
+    const std::map<ThresholdIntf::Type, std::map<ThresholdIntf::Bound, double>>&
+        b) -> bool
+{
+    auto sameBounds = [](const auto& x, const auto& y) {
+        return x.first == y.first && sameNumber(x.second, y.second);
+    };
+    return std::ranges::equal(a, b, [&](const auto& x, const auto& y) {
+        return x.first == y.first &&
+               std::ranges::equal(x.second, y.second, sameBounds);
+    });
+}
+
+Exporter::Exporter(sdbusplus::async::context& ctx,
+                   const std::string& socketPath) :
+    ctx(ctx), socketPath(socketPath)
+{
+    sockaddr_un addr{};
+    if (socketPath.empty() || socketPath.size() >= sizeof(addr.sun_path))
+    {
+        error("Invalid OpenMetrics socket path {PATH}", "PATH", socketPath);
+        return;
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0)
+    {
+        auto e = errno;
+        error("Failed to create OpenMetrics socket: {ERROR}", "ERROR",
+              strerror(e));
+        return;
+    }
+
+    unlink(socketPath.c_str());
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        chmod(socketPath.c_str(), 0660) != 0 || listen(listenFd, 8) != 0)
+    {
+        auto e = errno;
+        error("Failed to listen on OpenMetrics socket {PATH}: {ERROR}", "PATH",
+              socketPath, "ERROR", strerror(e));
+        close(listenFd);
+        listenFd = -1;
+        return;
+    }
+
+    info("Serving OpenMetrics on {PATH}", "PATH", socketPath);
+    ctx.spawn(serve());
+}
+
+Exporter::~Exporter()
+{
+    if (listenFd >= 0)
+    {
+        close(listenFd);
+        unlink(socketPath.c_str());
+    }
+}
+
+void Payload::render(const HealthMetric& metric, Entry& entry)
+{
+    auto name = escapeLabel(metric.getName());
+    auto path = escapeLabel(metric.getObjectPath());
+
+    entry.valueSample = std::format(
+        "bmc_health_metric{{name=\"{}\",path=\"{}\"}} {}\n", name, path,
+        to_number(entry.value));
+
+    entry.thresholdSamples.clear();
+    entry.assertedSamples.clear();
+    for (const auto& [type, bounds] : entry.thresholds)
+    {
+        for (const auto& [bound, value] : bounds)
+        {
+            auto labels = std::format(
+                "{{name=\"{}\",path=\"{}\",type=\"{}\",bound=\"{}\"}}", name,
+                path, to_label(type), to_label(bound));
+            entry.thresholdSamples += std::format(
+                "bmc_health_threshold{} {}\n", labels, to_number(value));
+            entry.assertedSamples += std::format(
+                "bmc_health_threshold_asserted{} {}\n", labels,
+                (entry.assertions & HealthMetric::assertionBit(type, bound))
+                    ? 1
+                    : 0);
+        }
+    }
+}
+
+void Payload::add(const HealthMetric& metric)
+{
+    auto& entry = entries[&metric];
+    entry.value = metric.ValueIntf::value();
+    entry.assertions = metric.getAssertionMask();
+    entry.thresholds = metric.ThresholdIntf::value();
+    render(metric, entry);
+    dirty = true;
+}
+
+auto Payload::update(const HealthMetric& metric) -> bool
+{
+    auto entry = entries.find(&metric);
+    if (entry == entries.end())
+    {
+        return false;
+    }
+
+    auto value = metric.ValueIntf::value();
+    auto assertions = metric.getAssertionMask();
+    auto thresholds = metric.ThresholdIntf::value();
+    if (sameNumber(value, entry->second.value) &&
+        assertions == entry->second.assertions &&
+        sameThresholds(thresholds, entry->second.thresholds))
+    {
+        return false;
+    }
+
+    entry->second.value = value;
+    entry->second.assertions = assertions;
+    entry->second.thresholds = std::move(thresholds);
+    render(metric, entry->second);
+    dirty = true;
+    return true;
+}
+
+void Payload::remove(const HealthMetric& metric)
+{
+    if (entries.erase(&metric) > 0)
+    {
+        dirty = true;
+    }
+}
+
+auto Payload::get() -> const std::string&
+{
+    if (!dirty)
+    {
+        return buffer;
+    }
+
+    buffer.clear();
+    buffer += valueFamily;
+    for (const auto& [metric, entry] : entries)
+    {
+        buffer += entry.valueSample;
+    }
+    buffer += thresholdFamily;
+    for (const auto& [metric, entry] : entries)
+    {
+        buffer += entry.thresholdSamples;
+    }
+    buffer += assertedFamily;
+    for (const auto& [metric, entry] : entries)
+    {
+        buffer += entry.assertedSamples;
+    }
+    buffer += eof;
+    dirty = false;
+    return buffer;
+}
+
+void Exporter::added(const HealthMetric& metric)
+{
+    if (listenFd >= 0)
+    {
+        payload.add(metric);
+    }
+}
+
+void Exporter::updated(const HealthMetric& metric)
+{
+    payload.update(metric);
+}
+
+void Exporter::removed(const HealthMetric& metric)
+{
+    payload.remove(metric);
+}
+
+auto Exporter::serve() -> sdbusplus::async::task<>
+{
+    sdbusplus::async::fdio fdio(ctx, listenFd);
+    while (!ctx.stop_requested())
+    {
+        co_await fdio.next();
+
+        int client = -1;
+        while ((client = accept4(listenFd, nullptr, nullptr,
+                                 SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+        {
+            const auto& data = payload.get();
+            // The kernel caps the size to net.core.wmem_max, a failure only
+            // means more writes
+            int size = static_cast<int>(data.size());
+            setsockopt(client, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+
+            auto sent = send(client, data.data(), data.size(),
+                             MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                auto e = errno;
+                error("Failed to write OpenMetrics payload: {ERROR}", "ERROR",
+                      strerror(e));
+                close(client);
+                continue;
+            }
+            auto written = static_cast<size_t>(std::max<ssize_t>(sent, 0));
+            if (written == data.size())
+            {
+                close(client);
+                continue;
+            }
+            // The payload may change before the scraper reads the rest
+            ctx.spawn(finish(client, data.substr(written)));
+        }
+    }
+}
+
+auto Exporter::finish(int client, std::string data) -> sdbusplus::async::task<>
+{
+    // fdio only waits for input, so the client is polled until it reads
+    auto deadline = std::chrono::steady_clock::now() + writeTimeout;
+    size_t written = 0;
+    while (written < data.size() && !ctx.stop_requested())
+    {
+        auto sent = send(client, data.data() + written, data.size() - written,
+                         MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent > 0)
+        {
+            written += sent;
+            continue;
+        }
+        if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            auto e = errno;
+            error("Failed to write OpenMetrics payload: {ERROR}", "ERROR",
+                  strerror(e));
+            break;
+        }
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            error("OpenMetrics scraper did not read {LEFT} bytes in time",
+                  "LEFT", data.size() - written);
+            break;
+        }
+        co_await sdbusplus::async::sleep_for(ctx, writeRetry);
+    }
+    close(client);
+}
+
+} // namespace phosphor::health::metric::openmetrics
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "health_metric.hpp"
+
+#include <sdbusplus/async.hpp>
+
+#include <string>
+#include <unordered_map>
+
+namespace phosphor::health::metric::openmetrics
+{
+
+/** @class Payload
+ *  @brief OpenMetrics text of the health metrics
+ *
+ *  Every metric keeps its samples preformatted and is only re-rendered when
+ *  its value, thresholds or assertions change. The concatenated text is only
+ *  rebuilt when a metric changed.
+ */
+class Payload
+{
+  public:
+    /** @brief Render a new metric */
+    void add(const HealthMetric& metric);
+    /** @brief Re-render a metric if it changed, returns whether it did */
+    auto update(const HealthMetric& metric) -> bool;
+    /** @brief Drop a metric */
+    void remove(const HealthMetric& metric);
+    /** @brief Get the current text, rebuilt only if a metric changed */
+    auto get() -> const std::string&;
+
+  private:
+    using thresholds_t =
+        std::map<ThresholdIntf::Type, std::map<ThresholdIntf::Bound, double>>;
+
+    struct Entry
+    {
+        /** @brief Last rendered value */
+        double value;
+        /** @brief Last rendered assertion mask */
+        uint32_t assertions;
+        /** @brief Last rendered threshold values */
+        thresholds_t thresholds;
+        /** @brief Preformatted bmc_health_metric sample */
+        std::string valueSample;
+        /** @brief Preformatted bmc_health_threshold samples */
+        std::string thresholdSamples;
+        /** @brief Preformatted bmc_health_threshold_asserted samples */
+        std::string assertedSamples;
+    };
+
+    /** @brief Render the samples of a metric into its entry */
+    static void render(const HealthMetric& metric, Entry& entry);
+
+    /** @brief Preformatted samples by metric */
+    std::unordered_map<const HealthMetric*, Entry> entries;
+    /** @brief Concatenated text served to scrapes */
+    std::string buffer;
+    /** @brief Set when an entry changed since the text was built */
+    bool dirty = true;
+};
+
+/** @class Exporter
+ *  @brief Serves the health metrics in OpenMetrics text format on a Unix
+ *         domain socket
+ *
+ *  A scrape gets the current payload and the connection is closed once it
+ *  is written. The send buffer is sized for the payload, so that it is
+ *  usually written at once, and any rest is written as the scraper reads.
+ */
+class Exporter : public MetricSink
+{
+  public:
+    Exporter() = delete;
+    Exporter(const Exporter&) = delete;
+    Exporter& operator=(const Exporter&) = delete;
+    Exporter(Exporter&&) = delete;
+    Exporter& operator=(Exporter&&) = delete;
+
+    /** @brief Listen on the given socket path, the exporter is inert on
+     *         failure */
+    Exporter(sdbusplus::async::context& ctx, const std::string& socketPath);
+    ~Exporter() override;
+
+    void added(const HealthMetric& metric) override;
+    void updated(const HealthMetric& metric) override;
+    void removed(const HealthMetric& metric) override;
+
+  private:
+    /** @brief Accept and serve scrapes */
+    auto serve() -> sdbusplus::async::task<>;
+    /** @brief Write the rest of a payload and close the client */
+    auto finish(int client, std::string data) -> sdbusplus::async::task<>;
+
+    /** @brief D-Bus context */
+    sdbusplus::async::context& ctx;
+    /** @brief Path of the listening socket */
+    std::string socketPath;
+    /** @brief Listening socket, -1 if the exporter is disabled */
+    int listenFd = -1;
+    /** @brief Text served to scrapes */
+    Payload payload;
+};
+
+} // namespace phosphor::health::metric::openmetrics
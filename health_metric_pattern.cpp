@@ -0,0 +1,162 @@
+#include "health_metric_pattern.hpp"
+
+#include <fnmatch.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+PHOSPHOR_LOG2_USING;
+
+namespace phosphor::health::metric::pattern
+{
+
+Matcher::Matcher(const std::string& binaryName) : text(binaryName)
+{
+    if (binaryName.size() > 2 && binaryName.front() == '/' &&
+        binaryName.back() == '/')
+    {
+        text = binaryName.substr(1, binaryName.size() - 2);
+        try
+        {
+            regex = std::regex(text, std::regex::ECMAScript |
+                                         std::regex::optimize);
+            kind = Kind::regex;
+        }
+        catch (const std::regex_error& e)
+        {
+            error("Invalid BinaryName regex {PATTERN}: {ERROR}", "PATTERN",
+                  binaryName, "ERROR", e);
+            // Never matches, see match()
+            kind = Kind::regex;
+            text.clear();
+        }
+    }
+    else if (binaryName.find_first_of("*?[") != std::string::npos)
+    {
+        kind = Kind::glob;
+    }
+}
+
+auto Matcher::match(const std::string& processName) const -> bool
+{
+    switch (kind)
+    {
+        case Kind::exact:
+            return processName == text;
+        case Kind::glob:
+            return fnmatch(text.c_str(), processName.c_str(), 0) == 0;
+        case Kind::regex:
+            return !text.empty() && std::regex_match(processName, regex);
+    }
+    return false;
+}
+
+auto instanceName(std::string_view configName, std::string_view instance)
+    -> std::string
+{
+    auto name = std::string(configName.substr(0, configName.find('_'))) + "_";
+    for (auto c : instance)
+    {
+        auto ch = static_cast<unsigned char>(c);
+        if (std::isalnum(ch))
+        {
+            name += static_cast<char>(std::tolower(ch));
+        }
+    }
+    if (name.back() == '_')
+    {
+        name += "root";
+    }
+    return name;
+}
+
+namespace details
+{
+/** @brief Decode the octal escapes mountinfo uses for whitespace */
+auto unescape(const std::string& field) -> std::string
+{
+    std::string result;
+    result.reserve(field.size());
+    for (size_t i = 0; i < field.size(); i++)
+    {
+        if (field[i] == '\\' && i + 3 < field.size() &&
+            std::all_of(field.begin() + i + 1, field.begin() + i + 4,
+                        [](char c) { return c >= '0' && c <= '7'; }))
+        {
+            result += static_cast<char>(std::stoi(field.substr(i + 1, 3),
+                                                  nullptr, 8));
+            i += 3;
+            continue;
+        }
+        result += field[i];
+    }
+    return result;
+}
+} // namespace details
+
+auto writableMounts(const std::string& mountinfo) -> std::vector<std::string>
+{
+    static constexpr auto pseudoTypes = std::to_array<std::string_view>(
+        {"autofs", "binfmt_misc", "bpf", "cgroup", "cgroup2", "configfs",
+         "debugfs", "devpts", "devtmpfs", "efivarfs", "fusectl", "hugetlbfs",
+         "mqueue", "nsfs", "proc", "pstore", "ramfs", "securityfs", "sysfs",
+         "tracefs"});
+    static constexpr auto pseudoDirs = std::to_array<std::string_view>(
+        {"/proc", "/sys", "/dev"});
+
+    std::vector<std::string> mounts;
+    std::ifstream file(mountinfo);
+    if (!file.is_open())
+    {
+        error("Unable to open {PATH} for reading mounts", "PATH", mountinfo);
+        return mounts;
+    }
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        // ID PARENT MAJ:MIN ROOT MOUNTPOINT OPTIONS [OPTIONAL...] - FSTYPE ...
+        std::istringstream iss(line);
+        std::string id, parent, device, root, mountPoint, options, field;
+        if (!(iss >> id >> parent >> device >> root >> mountPoint >> options))
+        {
+            continue;
+        }
+        while (iss >> field && field != "-")
+        {}
+        std::string fsType;
+        if (!(iss >> fsType))
+        {
+            continue;
+        }
+
+        if (!options.starts_with("rw") ||
+            (options.size() > 2 && options[2] != ',') ||
+            std::ranges::find(pseudoTypes, fsType) != pseudoTypes.end())
+        {
+            continue;
+        }
+        mountPoint = details::unescape(mountPoint);
+        if (std::ranges::any_of(pseudoDirs, [&mountPoint](auto dir) {
+                return mountPoint == dir ||
+                       (mountPoint.starts_with(dir) &&
+                        mountPoint[dir.size()] == '/');
+            }))
+        {
+            continue;
+        }
+        // A mount point may be stacked, only report it once
+        if (std::ranges::find(mounts, mountPoint) == mounts.end())
+        {
+            mounts.emplace_back(std::move(mountPoint));
+        }
+    }
+    return mounts;
+}
+
+} // namespace phosphor::health::metric::pattern
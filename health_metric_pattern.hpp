@@ -0,0 +1,65 @@
+#pragma once
+
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace phosphor::health::metric::pattern
+{
+
+/** @brief Path of a storage config which monitors all writable mounts */
+static constexpr auto autoPath = "auto";
+
+/** @class Matcher
+ *  @brief Binary name matcher, compiled once from a config BinaryName
+ *
+ *  A name wrapped in slashes, like "/^phosphor-.*$/", is an ECMAScript
+ *  regular expression. A name with any of the glob characters '*', '?' or
+ *  '[' is a shell glob. Anything else must match exactly.
+ */
+class Matcher
+{
+  public:
+    explicit Matcher(const std::string& binaryName);
+
+    /** @brief Check if the matcher is a glob or a regular expression */
+    auto isPattern() const -> bool
+    {
+        return kind != Kind::exact;
+    }
+
+    /** @brief Check if a process name matches */
+    auto match(const std::string& processName) const -> bool;
+
+  private:
+    enum class Kind
+    {
+        exact,
+        glob,
+        regex
+    };
+
+    Kind kind = Kind::exact;
+    std::string text;
+    std::regex regex;
+};
+
+/** @brief Build a metric name from a config name prefix and an instance
+ *
+ *  The instance is reduced to lowercase alphanumerics, like the last element
+ *  of the metric object path, e.g. ("Storage", "/var/Log") gives
+ *  "Storage_varlog".
+ */
+auto instanceName(std::string_view configName, std::string_view instance)
+    -> std::string;
+
+/** @brief Mount points of all writable, disk or tmpfs backed filesystems
+ *
+ *  Parses mountinfo in a single pass, pseudo filesystems and mounts below
+ *  /proc, /sys and /dev are skipped.
+ */
+auto writableMounts(const std::string& mountinfo = "/proc/self/mountinfo")
+    -> std::vector<std::string>;
+
+} // namespace phosphor::health::metric::pattern
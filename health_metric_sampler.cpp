@@ -0,0 +1,509 @@
+#include "health_metric_sampler.hpp"
+
+#include <dirent.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+extern "C"
+{
+#include <sys/statvfs.h>
+}
+
+PHOSPHOR_LOG2_USING;
+
+namespace phosphor::health::metric::sampler
+{
+
+int Sampler::hertz = phosphor::health::utils::getSystemClockFrequency();
+int Sampler::cpus = phosphor::health::utils::getNumberofCPU();
+
+enum CPUStatsIndex
+{
+    userIndex = 0,
+    niceIndex,
+    systemIndex,
+    idleIndex,
+    iowaitIndex,
+    irqIndex,
+    softirqIndex,
+    stealIndex,
+    guestUserIndex,
+    guestNiceIndex,
+    maxIndex
+};
+
+struct Sampler::Snapshot
+{
+    /** @brief Aggregated CPU times from /proc/stat */
+    std::optional<std::array<std::size_t, CPUStatsIndex::maxIndex>> cpuTimes;
+    /** @brief Memory values in kB from /proc/meminfo by subtype */
+    std::optional<std::unordered_map<SubType, double>> memoryValues;
+
+    auto getCPUTimes() -> const decltype(cpuTimes)&
+    {
+        if (!cpuTimes)
+        {
+            cpuTimes = readCPUTimes();
+        }
+        return cpuTimes;
+    }
+
+    auto getMemoryValues() -> const decltype(memoryValues)&
+    {
+        if (!memoryValues)
+        {
+            memoryValues = readMemoryValues();
+        }
+        return memoryValues;
+    }
+
+  private:
+    static auto readCPUTimes() -> decltype(cpuTimes)
+    {
+        constexpr auto procStat = "/proc/stat";
+        std::ifstream fileStat(procStat);
+        if (!fileStat.is_open())
+        {
+            error("Unable to open {PATH} for reading CPU stats", "PATH",
+                  procStat);
+            return std::nullopt;
+        }
+
+        std::string firstLine, labelName;
+        std::array<std::size_t, CPUStatsIndex::maxIndex> timeData{};
+
+        std::getline(fileStat, firstLine);
+        std::stringstream ss(firstLine);
+        ss >> labelName;
+
+        if (labelName.compare("cpu"))
+        {
+            error("CPU data not available");
+            return std::nullopt;
+        }
+
+        for (auto& time : timeData)
+        {
+            if (!(ss >> time))
+            {
+                error("CPU data not correct");
+                return std::nullopt;
+            }
+        }
+        return timeData;
+    }
+
+    static auto readMemoryValues() -> decltype(memoryValues)
+    {
+        constexpr auto procMeminfo = "/proc/meminfo";
+        std::ifstream memInfo(procMeminfo);
+        if (!memInfo.is_open())
+        {
+            error("Unable to open {PATH} for reading Memory stats", "PATH",
+                  procMeminfo);
+            return std::nullopt;
+        }
+        std::string line;
+        std::unordered_map<SubType, double> values;
+
+        while (std::getline(memInfo, line))
+        {
+            std::string name;
+            double value;
+            std::istringstream iss(line);
+
+            if (!(iss >> name >> value))
+            {
+                continue;
+            }
+            if (name.starts_with("MemAvailable"))
+            {
+                values[SubType::memoryAvailable] = value;
+            }
+            else if (name.starts_with("MemFree"))
+            {
+                values[SubType::memoryFree] = value;
+            }
+            else if (name.starts_with("Buffers") || name.starts_with("Cached"))
+            {
+                values[SubType::memoryBufferedAndCached] += value;
+            }
+            else if (name.starts_with("MemTotal"))
+            {
+                values[SubType::memoryTotal] = value;
+            }
+            else if (name.starts_with("Shmem"))
+            {
+                values[SubType::memoryShared] += value;
+            }
+        }
+        return values;
+    }
+};
+
+auto Sampler::read(const std::vector<Source>& sources) -> std::vector<Sample>
+{
+    std::vector<Sample> samples;
+    samples.reserve(sources.size());
+    Snapshot snapshot;
+
+    for (const auto& source : sources)
+    {
+        Sample sample{.type = source.type, .name = source.name};
+        switch (source.type)
+        {
+            case Type::cpu:
+                sample.value = readCPU(source, snapshot);
+                break;
+            case Type::memory:
+                sample.value = readMemory(source, snapshot);
+                break;
+            case Type::storage:
+                sample.value = readStorage(source);
+                break;
+            case Type::emmc:
+                sample.value = readEMMC(source);
+                break;
+            case Type::processCPU:
+            case Type::processMemory:
+                sample.pid = source.pid;
+                try
+                {
+                    sample.value = source.type == Type::processCPU
+                                       ? readProcessCPU(source)
+                                       : readProcessMemory(source, snapshot);
+                }
+                catch (const std::exception& e)
+                {
+                    error("Exception occured while reading process health "
+                          "metric for : {ERROR}",
+                          "ERROR", e.what());
+                    sample.exited = true;
+                }
+                break;
+            default:
+                error("Unknown health metric type {TYPE}", "TYPE",
+                      source.type);
+                continue;
+        }
+        samples.emplace_back(std::move(sample));
+    }
+    return samples;
+}
+
+auto Sampler::readCPU(const Source& source, Snapshot& snapshot)
+    -> std::optional<MValue>
+{
+    const auto& timeData = snapshot.getCPUTimes();
+    if (!timeData)
+    {
+        return std::nullopt;
+    }
+
+    uint64_t activeTime = 0, activeTimeDiff = 0, totalTime = 0,
+             totalTimeDiff = 0;
+    double activePercValue = 0;
+
+    if (source.subType == SubType::cpuTotal)
+    {
+        activeTime = (*timeData)[CPUStatsIndex::userIndex] +
+                     (*timeData)[CPUStatsIndex::niceIndex] +
+                     (*timeData)[CPUStatsIndex::systemIndex] +
+                     (*timeData)[CPUStatsIndex::irqIndex] +
+                     (*timeData)[CPUStatsIndex::softirqIndex] +
+                     (*timeData)[CPUStatsIndex::stealIndex] +
+                     (*timeData)[CPUStatsIndex::guestUserIndex] +
+                     (*timeData)[CPUStatsIndex::guestNiceIndex];
+    }
+    else if (source.subType == SubType::cpuKernel)
+    {
+        activeTime = (*timeData)[CPUStatsIndex::systemIndex];
+    }
+    else if (source.subType == SubType::cpuUser)
+    {
+        activeTime = (*timeData)[CPUStatsIndex::userIndex];
+    }
+
+    totalTime = std::accumulate(timeData->begin(), timeData->end(),
+                                decltype(totalTime){0});
+
+    activeTimeDiff = activeTime - preActiveTime[source.subType];
+    totalTimeDiff = totalTime - preTotalTime[source.subType];
+
+    /* Store current active and total time for next calculation */
+    preActiveTime[source.subType] = activeTime;
+    preTotalTime[source.subType] = totalTime;
+
+    activePercValue = (100.0 * activeTimeDiff) / totalTimeDiff;
+#ifdef ENABLE_DEBUG
+    debug("CPU Metric {SUBTYPE}: {VALUE}", "SUBTYPE", source.subType, "VALUE",
+          (double)activePercValue);
+#endif
+    /* For CPU, both user and monitor uses percentage values */
+    return MValue(activePercValue, 100);
+}
+
+auto Sampler::readMemory(const Source& source, Snapshot& snapshot)
+    -> std::optional<MValue>
+{
+    const auto& memoryValues = snapshot.getMemoryValues();
+    if (!memoryValues || !memoryValues->contains(source.subType) ||
+        !memoryValues->contains(SubType::memoryTotal))
+    {
+        return std::nullopt;
+    }
+    // Convert kB to Bytes
+    auto value = memoryValues->at(source.subType) * 1024;
+    auto total = memoryValues->at(SubType::memoryTotal) * 1024;
+#ifdef ENABLE_DEBUG
+    debug("Memory Metric {SUBTYPE}: {VALUE}, {TOTAL}", "SUBTYPE",
+          source.subType, "VALUE", value, "TOTAL", total);
+#endif
+    return MValue(value, total);
+}
+
+auto Sampler::readStorage(const Source& source) -> std::optional<MValue>
+{
+    struct statvfs buffer;
+#ifdef ENABLE_DEBUG
+    debug("Reading storage metric for {PATH}", "PATH", source.path);
+#endif
+    if (statvfs(source.path.c_str(), &buffer) != 0)
+    {
+        auto e = errno;
+        error("Error from statvfs: {ERROR}, path: {PATH}", "ERROR",
+              strerror(e), "PATH", source.path);
+        return std::nullopt;
+    }
+    double value = buffer.f_bfree * buffer.f_frsize;
+    double total = buffer.f_blocks * buffer.f_frsize;
+#ifdef ENABLE_DEBUG
+    debug("Storage Metric {SUBTYPE}: {VALUE}, {TOTAL}", "SUBTYPE",
+          source.subType, "VALUE", value, "TOTAL", total);
+#endif
+    return MValue(value, total);
+}
+
+auto Sampler::readEMMC(const Source& source) -> std::optional<MValue>
+{
+#ifdef ENABLE_DEBUG
+    debug("Reading eMMC metric for {PATH}", "PATH", source.path);
+#endif
+    std::ifstream emmcInfo(source.path);
+    if (!emmcInfo.is_open())
+    {
+        error("Unable to open {PATH} for reading eMMC stats", "PATH",
+              source.path);
+        return std::nullopt;
+    }
+    std::string line;
+    std::getline(emmcInfo, line);
+    std::istringstream iss(line);
+
+    switch (source.subType)
+    {
+        case SubType::emmcLifetime:
+        {
+            uint16_t lifetime_a = 0, lifetime_b = 0;
+            iss >> std::hex >> lifetime_a >> lifetime_b;
+#ifdef ENABLE_DEBUG
+            debug("EMMC Metric {SUBTYPE}: {VALUE}, {TOTAL}", "SUBTYPE",
+                  source.subType, "VALUE", lifetime_b, "TOTAL", 100);
+#endif
+            return MValue(lifetime_b, 100);
+        }
+        case SubType::emmcBlocks:
+        {
+            uint16_t pre_eol_info = 0;
+            iss >> std::hex >> pre_eol_info;
+#ifdef ENABLE_DEBUG
+            debug("EMMC Metric {SUBTYPE}: {VALUE}, {TOTAL}", "SUBTYPE",
+                  source.subType, "VALUE", pre_eol_info, "TOTAL", 100);
+#endif
+            return MValue(pre_eol_info, 100);
+        }
+        default:
+        {
+            error("Unknown eMMC metric sub-type {TYPE}", "TYPE",
+                  source.subType);
+            return std::nullopt;
+        }
+    }
+}
+
+auto Sampler::readProcessCPU(const Source& source) -> std::optional<MValue>
+{
+#ifdef ENABLE_DEBUG
+    debug("Reading process CPU metric for {NAME}", "NAME", source.name);
+#endif
+    int pid = source.pid;
+    std::string statFilePath = "/proc/" + std::to_string(pid) + "/stat";
+    std::ifstream statFile(statFilePath);
+    if (!statFile.is_open())
+    {
+        error("Failed to open {PATH} for reading process CPU stats", "PATH",
+              statFilePath);
+        throw std::runtime_error(source.name);
+    }
+
+    // Read the line from the stat file
+    std::string line;
+    std::getline(statFile, line);
+    statFile.close();
+
+    // Parse the line to extract the required fields
+    std::istringstream iss(line);
+    std::string comm, state;
+    int ppid, pgrp, session, tty_nr, tpgid, flags, minflt, cminflt, majflt,
+        cmajflt;
+
+    int utime, stime, cutime, cstime;
+    long priority, nice, num_threads, itrealvalue;
+    int starttime;
+
+    // Extract the required fields from the line
+    iss >> pid >> comm >> state >> ppid >> pgrp >> session >> tty_nr >>
+        tpgid >> flags >> minflt >> cminflt >> majflt >> cmajflt >> utime >>
+        stime >> cutime >> cstime >> priority >> nice >> num_threads >>
+        itrealvalue >> starttime;
+
+    // Calculate the total time spent by the process in user mode and kernel
+    // mode
+    int activeTime = utime + stime; // + cutime + cstime;
+#ifdef ENABLE_DEBUG
+    debug("activeTime is {ACTIVE_TIME}", "ACTIVE_TIME", activeTime);
+#endif
+
+    struct timeval t;
+    float elapsedTime;
+    gettimeofday(&t, nullptr);
+
+    if (preElapsedTime.find(pid) == preElapsedTime.end() ||
+        preProcessActiveTime.find(pid) == preProcessActiveTime.end())
+    {
+        preElapsedTime[pid] = std::make_pair(0, 0);
+        preProcessActiveTime[pid] = 0;
+    }
+
+    elapsedTime = (t.tv_sec - preElapsedTime[pid].first) +
+                  (float)(t.tv_usec - preElapsedTime[pid].second) / 1000000.0;
+
+    preElapsedTime[pid] = std::make_pair(t.tv_sec, t.tv_usec);
+    debug("elapsedTime is {ELAPSED_TIME}", "ELAPSED_TIME", elapsedTime);
+
+    int activeTimeDiff = activeTime - preProcessActiveTime[pid];
+    debug("activeTimeDiff is {ACTIVE_TIME_DIFF}", "ACTIVE_TIME_DIFF",
+          activeTimeDiff);
+    preProcessActiveTime[pid] = activeTime;
+#ifdef ENABLE_DEBUG
+    debug("hertz is {HERTZ}", "HERTZ", hertz);
+    debug("cpus is {CPUS}", "CPUS", cpus);
+#endif
+
+    if (elapsedTime <= 0 || hertz <= 0 || cpus <= 0)
+    {
+        return std::nullopt;
+    }
+
+    // Calculate the CPU usage percentage
+    double cpuUsagePercentage = (activeTimeDiff / cpus) * (100 / hertz) /
+                                elapsedTime;
+#ifdef ENABLE_DEBUG
+    debug("CPU percentage for process {PID} is {CPU_PERCENTAGE}", "PID", pid,
+          "CPU_PERCENTAGE", cpuUsagePercentage);
+#endif
+    if (cpuUsagePercentage > 100)
+    {
+        cpuUsagePercentage = 100;
+    }
+    /* Update percentage values */
+    return MValue(cpuUsagePercentage, 100.0);
+}
+
+auto Sampler::readProcessMemory(const Source& source, Snapshot& snapshot)
+    -> std::optional<MValue>
+{
+    // Build the path to the statm file for the specified process ID
+    std::string statmPath = "/proc/" + std::to_string(source.pid) + "/statm";
+    std::ifstream statmFile(statmPath);
+    // Open the statm file for reading
+    if (!statmFile.is_open())
+    {
+        error("Failed to open {PATH} for reading process memory stats", "PATH",
+              statmPath);
+        throw std::runtime_error(source.name);
+    }
+    // Read the resident set size (RSS) from the statm file
+    long long resident;
+    statmFile >> resident;
+
+    const auto& memoryValues = snapshot.getMemoryValues();
+    if (!memoryValues || !memoryValues->contains(SubType::memoryTotal) ||
+        memoryValues->at(SubType::memoryTotal) <= 0)
+    {
+        return std::nullopt;
+    }
+    double totalMemoryKB = memoryValues->at(SubType::memoryTotal);
+
+    // Calculate memory usage in kilo bytes
+    long long memoryUsageKB = resident * sysconf(_SC_PAGESIZE) / 1024;
+    double memoryUsagePercentage = static_cast<double>(memoryUsageKB) /
+                                   totalMemoryKB * 100.0;
+#ifdef ENABLE_DEBUG
+    debug("Memory percentage for process {PID} is {MEMORY_PERCENTAGE}", "PID",
+          source.pid, "MEMORY_PERCENTAGE", memoryUsagePercentage);
+#endif
+    return MValue(memoryUsagePercentage, 100);
+}
+
+auto listProcesses() -> processes_t
+{
+    processes_t processes;
+    DIR* dir = opendir("/proc");
+    if (!dir)
+    {
+        error("Failed to open the /proc directory");
+        return processes;
+    }
+    dirent* entry;
+    while ((entry = readdir(dir)))
+    {
+        if (entry->d_type != DT_DIR)
+        {
+            continue;
+        }
+        // Check if the directory name is a number (potential process ID)
+        if (!phosphor::health::utils::containsOnlyDigits(entry->d_name))
+        {
+            continue;
+        }
+        int pid = std::stoi(entry->d_name);
+        if (pid == 0)
+        {
+            continue;
+        }
+
+        // Build the path to the "comm" file for this process
+        std::string commPath = "/proc/" + std::to_string(pid) + "/comm";
+        std::ifstream commFile(commPath);
+        if (!commFile)
+        {
+            continue;
+        }
+        std::string processName;
+        std::getline(commFile, processName);
+        processes.emplace_back(pid, std::move(processName));
+    }
+    closedir(dir);
+    return processes;
+}
+
+} // namespace phosphor::health::metric::sampler
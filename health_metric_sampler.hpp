@@ -0,0 +1,104 @@
+#pragma once
+
+#include "health_metric.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace phosphor::health::metric::sampler
+{
+
+/** @brief A metric to sample, as seen by the collector */
+struct Source
+{
+    /** @brief Metric type */
+    Type type;
+    /** @brief Metric name, the key of the metric in its collection */
+    std::string name;
+    /** @brief Metric subtype */
+    SubType subType;
+    /** @brief Storage mount point or eMMC file */
+    std::string path;
+    /** @brief Process ID of a process metric */
+    int pid = 0;
+
+    auto operator==(const Source&) const -> bool = default;
+};
+
+/** @brief A sampled value of a metric */
+struct Sample
+{
+    /** @brief Metric type */
+    Type type;
+    /** @brief Metric name */
+    std::string name;
+    /** @brief Process ID the value was read for, 0 for system metrics */
+    int pid = 0;
+    /** @brief Sampled value, unset if the metric could not be read */
+    std::optional<MValue> value = std::nullopt;
+    /** @brief Set if the process of a process metric could not be read */
+    bool exited = false;
+};
+
+/** @brief Process IDs and names, see listProcesses() */
+using processes_t = std::vector<std::pair<int, std::string>>;
+
+/** @brief List the running processes with their comm names from /proc */
+auto listProcesses() -> processes_t;
+
+/** @class Sampler
+ *  @brief Reads metric values from /proc, sysfs and the filesystems
+ *
+ *  A sampler does no D-Bus access, so it can run on the collector thread.
+ *  It keeps the previous counters of the CPU metrics to compute the usage
+ *  between two reads, so one sampler should be used for all reads.
+ */
+class Sampler
+{
+  public:
+    /** @brief Read the values of all sources
+     *
+     *  /proc/stat and /proc/meminfo are read at most once per call, however
+     *  many sources use them.
+     */
+    auto read(const std::vector<Source>& sources) -> std::vector<Sample>;
+
+  private:
+    /** @brief Files shared by the sources of one read */
+    struct Snapshot;
+
+    /** @brief Read the CPU usage of a subtype */
+    auto readCPU(const Source& source, Snapshot& snapshot)
+        -> std::optional<MValue>;
+    /** @brief Read the memory usage of a subtype */
+    auto readMemory(const Source& source, Snapshot& snapshot)
+        -> std::optional<MValue>;
+    /** @brief Read the free space of a mount point */
+    auto readStorage(const Source& source) -> std::optional<MValue>;
+    /** @brief Read the eMMC health */
+    auto readEMMC(const Source& source) -> std::optional<MValue>;
+    /** @brief Read the CPU usage of a process, throws if it exited */
+    auto readProcessCPU(const Source& source) -> std::optional<MValue>;
+    /** @brief Read the memory usage of a process, throws if it exited */
+    auto readProcessMemory(const Source& source, Snapshot& snapshot)
+        -> std::optional<MValue>;
+
+    /** @brief Previous active time by CPU subtype */
+    std::unordered_map<SubType, uint64_t> preActiveTime;
+    /** @brief Previous total time by CPU subtype */
+    std::unordered_map<SubType, uint64_t> preTotalTime;
+    /** @brief Previous sample time by process ID */
+    std::unordered_map<int, std::pair<time_t, suseconds_t>> preElapsedTime;
+    /** @brief Previous active time by process ID */
+    std::unordered_map<int, int> preProcessActiveTime;
+    /** @brief Total number of CPUs */
+    static int cpus;
+    /** @brief Clock ticks per second */
+    static int hertz;
+};
+
+} // namespace phosphor::health::metric::sampler
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+namespace phosphor::health::metric::serialize
+{
+
+/** @class Writer
+ *  @brief Appends values in host byte order, strings with a u16 length
+ */
+class Writer
+{
+  public:
+    template <typename T>
+        requires std::is_arithmetic_v<T>
+    void put(T value)
+    {
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void put(const std::string& value)
+    {
+        put(static_cast<uint16_t>(value.size()));
+        buffer.append(value);
+    }
+
+    std::string buffer;
+};
+
+/** @class Reader
+ *  @brief Reads the values appended by a Writer, false past the end
+ */
+class Reader
+{
+  public:
+    Reader(const char* data, size_t size) : data(data), end(data + size) {}
+
+    template <typename T>
+        requires std::is_arithmetic_v<T>
+    auto get(T& value) -> bool
+    {
+        if (static_cast<size_t>(end - data) < sizeof(value))
+        {
+            return false;
+        }
+        std::memcpy(&value, data, sizeof(value));
+        data += sizeof(value);
+        return true;
+    }
+
+    auto get(std::string& value) -> bool
+    {
+        uint16_t size = 0;
+        if (!get(size) || static_cast<size_t>(end - data) < size)
+        {
+            return false;
+        }
+        value.assign(data, size);
+        data += size;
+        return true;
+    }
+
+    auto done() const -> bool
+    {
+        return data == end;
+    }
+
+  private:
+    const char* data;
+    const char* end;
+};
+
+/** @brief Replace a file through a temporary file and a rename, so that a
+ *         concurrent or interrupted reader never sees a partial file */
+inline auto replaceFile(const std::string& fileName, const std::string& data)
+    -> std::error_code
+{
+    std::error_code ec;
+    auto path = std::filesystem::path(fileName);
+    std::filesystem::create_directories(path.parent_path(), ec);
+    auto tmpFile = fileName + ".tmp";
+    {
+        std::ofstream file(tmpFile, std::ios::binary | std::ios::trunc);
+        if (!file.write(data.data(), data.size()))
+        {
+            return std::make_error_code(std::errc::io_error);
+        }
+    }
+    std::filesystem::rename(tmpFile, path, ec);
+    if (ec)
+    {
+        std::error_code ignored;
+        std::filesystem::remove(tmpFile, ignored);
+    }
+    return ec;
+}
+
+} // namespace phosphor::health::metric::serialize
@@ -0,0 +1,231 @@
+#pragma once
+
+/*
+ * Shared-memory export of the latest health metric values.
+ *
+ * health-monitor publishes the value, sample time and asserted thresholds of
+ * every metric into a POSIX shared-memory segment. Each slot is protected by a
+ * seqlock, so local consumers can read all metrics without any syscall or
+ * D-Bus traffic once the segment is mapped.
+ *
+ * This header has no dependency beyond the C++ standard library and POSIX and
+ * can be used directly by clients, see shm::Reader.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace phosphor::health::metric::shm
+{
+
+/** @brief Default name of the shared-memory segment */
+static constexpr auto defaultName = "/phosphor-health-monitor";
+/** @brief Marker for an initialized segment, "HMON" */
+static constexpr uint32_t magic = 0x484d4f4e;
+/** @brief Layout version, bumped on incompatible changes */
+static constexpr uint32_t version = 1;
+/** @brief Maximum number of metrics in the segment */
+static constexpr size_t maxMetrics = 256;
+/** @brief Maximum length of a metric object path, including terminator */
+static constexpr size_t maxPathLength = 128;
+
+/** @brief Threshold types, in xyz.openbmc_project.Common.Threshold order */
+enum class ThresholdType : uint8_t
+{
+    hardShutdown,
+    softShutdown,
+    performanceLoss,
+    critical,
+    warning
+};
+
+/** @brief Threshold bounds, in xyz.openbmc_project.Common.Threshold order */
+enum class ThresholdBound : uint8_t
+{
+    lower,
+    upper
+};
+
+/** @brief Bit in the assertion mask for the given threshold */
+constexpr auto assertionBit(ThresholdType type, ThresholdBound bound)
+    -> uint32_t
+{
+    return 1u << (std::to_underlying(type) * 2 + std::to_underlying(bound));
+}
+
+struct Slot
+{
+    /** @brief Sequence counter, odd while the writer updates the slot */
+    std::atomic<uint32_t> sequence;
+    /** @brief Bitmask of asserted thresholds, see assertionBit() */
+    uint32_t assertions;
+    /** @brief Latest metric value */
+    double value;
+    /** @brief Sample time in milliseconds since the epoch */
+    uint64_t timestamp;
+    /** @brief D-Bus object path of the metric, empty for a free slot */
+    char path[maxPathLength];
+};
+
+struct Header
+{
+    /** @brief Set to magic once the segment is ready, cleared on exit */
+    std::atomic<uint32_t> magic;
+    /** @brief Layout version */
+    uint32_t version;
+    /** @brief Number of slots in the segment */
+    uint32_t capacity;
+    /** @brief Number of slots ever used, readers scan up to this index */
+    std::atomic<uint32_t> used;
+};
+
+struct Segment
+{
+    Header header;
+    Slot slots[maxMetrics];
+};
+
+/** @brief Snapshot of one metric read from the segment */
+struct Metric
+{
+    /** @brief D-Bus object path of the metric */
+    std::string path;
+    /** @brief Latest metric value */
+    double value;
+    /** @brief Sample time in milliseconds since the epoch */
+    uint64_t timestamp;
+    /** @brief Bitmask of asserted thresholds, see assertionBit() */
+    uint32_t assertions;
+};
+
+/** @brief Write one slot under the seqlock */
+inline void write(Slot& slot, const char* path, double value,
+                  uint64_t timestamp, uint32_t assertions)
+{
+    auto sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.value = value;
+    slot.timestamp = timestamp;
+    slot.assertions = assertions;
+    if (path != nullptr)
+    {
+        std::strncpy(slot.path, path, maxPathLength - 1);
+        slot.path[maxPathLength - 1] = '\0';
+    }
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+/** @brief Read one slot under the seqlock, false if the slot is free */
+inline auto read(const Slot& slot, Metric& metric) -> bool
+{
+    Slot copy;
+    uint32_t sequence = 0;
+    do
+    {
+        sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence & 1)
+        {
+            continue;
+        }
+        copy.value = slot.value;
+        copy.timestamp = slot.timestamp;
+        copy.assertions = slot.assertions;
+        std::memcpy(copy.path, slot.path, maxPathLength);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((sequence & 1) ||
+             sequence != slot.sequence.load(std::memory_order_relaxed));
+
+    copy.path[maxPathLength - 1] = '\0';
+    if (copy.path[0] == '\0')
+    {
+        return false;
+    }
+    metric.path = copy.path;
+    metric.value = copy.value;
+    metric.timestamp = copy.timestamp;
+    metric.assertions = copy.assertions;
+    return true;
+}
+
+/** @class Reader
+ *  @brief Read-only mapping of the health metric segment for clients
+ */
+class Reader
+{
+  public:
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    /** @brief Map the segment, throws std::system_error on failure */
+    explicit Reader(const char* name = defaultName)
+    {
+        auto fd = shm_open(name, O_RDONLY, 0);
+        if (fd < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), name);
+        }
+        auto addr = mmap(nullptr, sizeof(Segment), PROT_READ, MAP_SHARED, fd,
+                         0);
+        auto e = errno;
+        close(fd);
+        if (addr == MAP_FAILED)
+        {
+            throw std::system_error(e, std::generic_category(), name);
+        }
+        segment = static_cast<const Segment*>(addr);
+    }
+
+    ~Reader()
+    {
+        munmap(const_cast<Segment*>(segment), sizeof(Segment));
+    }
+
+    /** @brief Check if the segment is still owned by a running writer
+     *
+     *  The writer clears the magic on exit. A client should drop the Reader
+     *  and map the segment again once this returns false.
+     */
+    auto valid() const -> bool
+    {
+        return segment->header.magic.load(std::memory_order_acquire) ==
+                   magic &&
+               segment->header.version == version;
+    }
+
+    /** @brief Read all metrics currently in the segment */
+    auto read() const -> std::vector<Metric>
+    {
+        std::vector<Metric> metrics;
+        auto used = std::min<uint32_t>(
+            segment->header.used.load(std::memory_order_acquire), maxMetrics);
+        metrics.reserve(used);
+        Metric metric;
+        for (uint32_t i = 0; i < used; i++)
+        {
+            if (shm::read(segment->slots[i], metric))
+            {
+                metrics.push_back(metric);
+            }
+        }
+        return metrics;
+    }
+
+  private:
+    const Segment* segment = nullptr;
+};
+
+} // namespace phosphor::health::metric::shm
@@ -0,0 +1,145 @@
+#include "health_metric_shm_writer.hpp"
+
+#include "health_metric.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <chrono>
+#include <limits>
+#include <new>
+
+PHOSPHOR_LOG2_USING;
+
+namespace phosphor::health::metric::shm
+{
+
+static_assert(assertionBit(ThresholdType::critical, ThresholdBound::upper) ==
+              HealthMetric::assertionBit(ThresholdIntf::Type::Critical,
+                                         ThresholdIntf::Bound::Upper));
+static_assert(assertionBit(ThresholdType::warning, ThresholdBound::lower) ==
+              HealthMetric::assertionBit(ThresholdIntf::Type::Warning,
+                                         ThresholdIntf::Bound::Lower));
+
+Writer::Writer(const std::string& name) : name(name)
+{
+    // Drop a segment left behind by a previous instance, readers still
+    // mapping it see the cleared magic and re-open.
+    shm_unlink(name.c_str());
+
+    auto fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        auto e = errno;
+        error("Failed to create shared memory {NAME}: {ERROR}", "NAME", name,
+              "ERROR", strerror(e));
+        return;
+    }
+    if (ftruncate(fd, sizeof(Segment)) != 0)
+    {
+        auto e = errno;
+        error("Failed to size shared memory {NAME}: {ERROR}", "NAME", name,
+              "ERROR", strerror(e));
+        close(fd);
+        shm_unlink(name.c_str());
+        return;
+    }
+    auto addr = mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd, 0);
+    auto e = errno;
+    close(fd);
+    if (addr == MAP_FAILED)
+    {
+        error("Failed to map shared memory {NAME}: {ERROR}", "NAME", name,
+              "ERROR", strerror(e));
+        shm_unlink(name.c_str());
+        return;
+    }
+
+    segment = new (addr) Segment{};
+    segment->header.version = version;
+    segment->header.capacity = maxMetrics;
+    segment->header.magic.store(magic, std::memory_order_release);
+    info("Publishing health metrics to shared memory {NAME}", "NAME", name);
+}
+
+Writer::~Writer()
+{
+    if (segment == nullptr)
+    {
+        return;
+    }
+    segment->header.magic.store(0, std::memory_order_release);
+    munmap(segment, sizeof(Segment));
+    shm_unlink(name.c_str());
+}
+
+auto Writer::allocate(const std::string& path) -> Slot*
+{
+    if (segment == nullptr)
+    {
+        return nullptr;
+    }
+
+    auto used = segment->header.used.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < used; i++)
+    {
+        auto& slot = segment->slots[i];
+        if (slot.path[0] == '\0')
+        {
+            write(slot, path.c_str(), std::numeric_limits<double>::quiet_NaN(),
+                  0, 0);
+            return &slot;
+        }
+    }
+    if (used >= maxMetrics)
+    {
+        error("No free shared memory slot for {PATH}", "PATH", path);
+        return nullptr;
+    }
+
+    auto& slot = segment->slots[used];
+    write(slot, path.c_str(), std::numeric_limits<double>::quiet_NaN(), 0, 0);
+    segment->header.used.store(used + 1, std::memory_order_release);
+    return &slot;
+}
+
+void Writer::publish(Slot& slot, double value, uint32_t assertions)
+{
+    auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count();
+    write(slot, nullptr, value, timestamp, assertions);
+}
+
+void Writer::release(Slot& slot)
+{
+    write(slot, "", std::numeric_limits<double>::quiet_NaN(), 0, 0);
+}
+
+void Writer::added(const HealthMetric& metric)
+{
+    if (auto slot = allocate(metric.getObjectPath()); slot != nullptr)
+    {
+        slots.emplace(&metric, slot);
+    }
+}
+
+void Writer::updated(const HealthMetric& metric)
+{
+    if (auto slot = slots.find(&metric); slot != slots.end())
+    {
+        publish(*slot->second, metric.ValueIntf::value(),
+                metric.getAssertionMask());
+    }
+}
+
+void Writer::removed(const HealthMetric& metric)
+{
+    if (auto slot = slots.find(&metric); slot != slots.end())
+    {
+        release(*slot->second);
+        slots.erase(slot);
+    }
+}
+
+} // namespace phosphor::health::metric::shm
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "health_metric_shm.hpp"
+#include "health_metric_sink.hpp"
+
+#include <string>
+#include <unordered_map>
+
+namespace phosphor::health::metric::shm
+{
+
+/** @class Writer
+ *  @brief Publishes health metrics into the shared-memory segment
+ */
+class Writer : public MetricSink
+{
+  public:
+    Writer() = delete;
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+    Writer(Writer&&) = delete;
+    Writer& operator=(Writer&&) = delete;
+
+    /** @brief Create and map the segment, the writer is inert on failure */
+    explicit Writer(const std::string& name);
+    ~Writer() override;
+
+    void added(const HealthMetric& metric) override;
+    void updated(const HealthMetric& metric) override;
+    void removed(const HealthMetric& metric) override;
+
+    /** @brief Reserve a slot for the given object path */
+    auto allocate(const std::string& path) -> Slot*;
+    /** @brief Publish a new sample into the slot */
+    void publish(Slot& slot, double value, uint32_t assertions);
+    /** @brief Release the slot for reuse */
+    void release(Slot& slot);
+
+  private:
+    /** @brief Name of the shared-memory segment */
+    std::string name;
+    /** @brief Mapped segment, null if the segment could not be created */
+    Segment* segment = nullptr;
+    /** @brief Slot of every published metric */
+    std::unordered_map<const HealthMetric*, Slot*> slots;
+};
+
+} // namespace phosphor::health::metric::shm
@@ -0,0 +1,26 @@
+#pragma once
+
+namespace phosphor::health::metric
+{
+
+class HealthMetric;
+
+/** @class MetricSink
+ *  @brief Consumer of health metric updates besides the D-Bus objects
+ */
+class MetricSink
+{
+  public:
+    virtual ~MetricSink() = default;
+
+    /** @brief Called after a metric object is created */
+    virtual void added(const HealthMetric& metric) = 0;
+    /** @brief Called after every new sample of a metric */
+    virtual void updated(const HealthMetric& metric) = 0;
+    /** @brief Called before a metric object is destroyed */
+    virtual void removed(const HealthMetric& metric) = 0;
+    /** @brief Called once at the end of every collection tick */
+    virtual void flush() {}
+};
+
+} // namespace phosphor::health::metric
@@ -0,0 +1,307 @@
+#include "health_metric_state.hpp"
+
+#include "health_metric.hpp"
+#include "health_metric_serialize.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <fstream>
+#include <iterator>
+
+PHOSPHOR_LOG2_USING;
+
+namespace phosphor::health::metric::state
+{
+
+/*
+ * State layout, in host byte order:
+ *
+ *   u32 magic, u32 version, str boot ID, u32 metric count
+ *   per metric:
+ *     str object path, f64 lastTotal, f64 lastNotifiedValue,
+ *     u32 sample count, f64 per sample, u8 threshold count
+ *     per threshold:
+ *       u8 type, u8 bound, u8 asserted, u8 flapping, i64 assertedAt,
+ *       i64 violatedAt, u16 transition count, i64 per transition
+ *   u32 rate limit count
+ *   per rate limit:
+ *     str metric, u8 type, u8 bound, str target, f64 burst, u32 period,
+ *     f64 tokens, i64 last
+ *
+ * where str is a u16 length followed by the characters and times are steady
+ * clock nanoseconds.
+ */
+static constexpr uint32_t magic = 0x54534d48; // "HMST"
+static constexpr uint32_t version = 1;
+
+namespace
+{
+
+using serialize::Reader;
+using serialize::Writer;
+
+void put(Writer& writer, clock_t::time_point time)
+{
+    writer.put(static_cast<int64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            time.time_since_epoch())
+            .count()));
+}
+
+auto get(Reader& reader, clock_t::time_point& time) -> bool
+{
+    int64_t nanoseconds = 0;
+    if (!reader.get(nanoseconds))
+    {
+        return false;
+    }
+    time = clock_t::time_point(std::chrono::duration_cast<clock_t::duration>(
+        std::chrono::nanoseconds(nanoseconds)));
+    return true;
+}
+
+auto decode(Reader& reader, std::unordered_map<std::string, Metric>& metrics)
+    -> bool
+{
+    uint32_t count = 0;
+    if (!reader.get(count))
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        std::string path;
+        Metric metric;
+        uint32_t samples = 0;
+        uint8_t thresholdCount = 0;
+        if (!reader.get(path) || !reader.get(metric.lastTotal) ||
+            !reader.get(metric.lastNotifiedValue) || !reader.get(samples))
+        {
+            return false;
+        }
+        for (uint32_t j = 0; j < samples; j++)
+        {
+            double sample = 0;
+            if (!reader.get(sample))
+            {
+                return false;
+            }
+            metric.history.push_back(sample);
+        }
+        if (!reader.get(thresholdCount))
+        {
+            return false;
+        }
+        for (uint8_t j = 0; j < thresholdCount; j++)
+        {
+            uint8_t type = 0;
+            uint8_t bound = 0;
+            uint8_t asserted = 0;
+            uint8_t flapping = 0;
+            uint16_t transitions = 0;
+            Threshold threshold;
+            if (!reader.get(type) || !reader.get(bound) ||
+                !reader.get(asserted) || !reader.get(flapping) ||
+                !get(reader, threshold.assertedAt) ||
+                !get(reader, threshold.violatedAt) ||
+                !reader.get(transitions))
+            {
+                return false;
+            }
+            threshold.type = static_cast<ThresholdIntf::Type>(type);
+            threshold.bound = static_cast<ThresholdIntf::Bound>(bound);
+            threshold.asserted = (asserted != 0);
+            threshold.flapping = (flapping != 0);
+            for (uint16_t k = 0; k < transitions; k++)
+            {
+                clock_t::time_point transition;
+                if (!get(reader, transition))
+                {
+                    return false;
+                }
+                threshold.transitions.push_back(transition);
+            }
+            metric.thresholds.emplace_back(std::move(threshold));
+        }
+        metrics.emplace(std::move(path), std::move(metric));
+    }
+    return true;
+}
+
+auto decode(Reader& reader, std::vector<ratelimit::RateLimiter::Entry>& entries)
+    -> bool
+{
+    uint32_t count = 0;
+    if (!reader.get(count))
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint8_t type = 0;
+        uint8_t bound = 0;
+        uint32_t period = 0;
+        ratelimit::RateLimiter::Entry entry;
+        if (!reader.get(entry.key.metric) || !reader.get(type) ||
+            !reader.get(bound) || !reader.get(entry.key.target) ||
+            !reader.get(entry.limit.burst) || !reader.get(period) ||
+            !reader.get(entry.tokens) || !get(reader, entry.last))
+        {
+            return false;
+        }
+        entry.key.type = static_cast<ThresholdIntf::Type>(type);
+        entry.key.bound = static_cast<ThresholdIntf::Bound>(bound);
+        entry.limit.period = std::chrono::seconds(period);
+        entries.emplace_back(std::move(entry));
+    }
+    return true;
+}
+
+} // namespace
+
+Store::Store(std::string file, std::chrono::seconds interval) :
+    file(std::move(file)), interval(interval), bootId(utils::getBootId())
+{}
+
+auto Store::load() -> bool
+{
+    std::ifstream stream(file, std::ios::binary);
+    if (!stream)
+    {
+        return false;
+    }
+    std::string data{std::istreambuf_iterator<char>(stream),
+                     std::istreambuf_iterator<char>()};
+
+    Reader reader(data.data(), data.size());
+    uint32_t fileMagic = 0;
+    uint32_t fileVersion = 0;
+    std::string fileBootId;
+    if (!reader.get(fileMagic) || fileMagic != magic ||
+        !reader.get(fileVersion) || fileVersion != version ||
+        !reader.get(fileBootId))
+    {
+        info("Ignoring invalid health metric state {PATH}", "PATH", file);
+        return false;
+    }
+    if (fileBootId != bootId)
+    {
+        info("Ignoring health metric state {PATH} of a previous boot", "PATH",
+             file);
+        return false;
+    }
+
+    std::unordered_map<std::string, Metric> metricStates;
+    std::vector<ratelimit::RateLimiter::Entry> entries;
+    if (!decode(reader, metricStates) || !decode(reader, entries) ||
+        !reader.done())
+    {
+        info("Ignoring invalid health metric state {PATH}", "PATH", file);
+        return false;
+    }
+    loaded = std::move(metricStates);
+    rateLimits = std::move(entries);
+    info("Loaded the state of {COUNT} health metrics from {PATH}", "COUNT",
+         loaded.size(), "PATH", file);
+    return true;
+}
+
+void Store::save()
+{
+    Writer writer;
+    writer.put(magic);
+    writer.put(version);
+    writer.put(bootId);
+
+    writer.put(static_cast<uint32_t>(metrics.size()));
+    for (const auto& [path, metric] : metrics)
+    {
+        auto state = metric->getState();
+        writer.put(path);
+        writer.put(state.lastTotal);
+        writer.put(state.lastNotifiedValue);
+        writer.put(static_cast<uint32_t>(state.history.size()));
+        for (auto sample : state.history)
+        {
+            writer.put(sample);
+        }
+        writer.put(static_cast<uint8_t>(state.thresholds.size()));
+        for (const auto& threshold : state.thresholds)
+        {
+            writer.put(static_cast<uint8_t>(threshold.type));
+            writer.put(static_cast<uint8_t>(threshold.bound));
+            writer.put(static_cast<uint8_t>(threshold.asserted));
+            writer.put(static_cast<uint8_t>(threshold.flapping));
+            put(writer, threshold.assertedAt);
+            put(writer, threshold.violatedAt);
+            writer.put(static_cast<uint16_t>(threshold.transitions.size()));
+            for (auto transition : threshold.transitions)
+            {
+                put(writer, transition);
+            }
+        }
+    }
+
+    auto entries = HealthMetric::getActionLimiter().entries();
+    writer.put(static_cast<uint32_t>(entries.size()));
+    for (const auto& entry : entries)
+    {
+        writer.put(entry.key.metric);
+        writer.put(static_cast<uint8_t>(entry.key.type));
+        writer.put(static_cast<uint8_t>(entry.key.bound));
+        writer.put(entry.key.target);
+        writer.put(entry.limit.burst);
+        writer.put(static_cast<uint32_t>(entry.limit.period.count()));
+        writer.put(entry.tokens);
+        put(writer, entry.last);
+    }
+
+    if (auto ec = serialize::replaceFile(file, writer.buffer))
+    {
+        warning("Unable to write health metric state {PATH}: {ERROR}", "PATH",
+                file, "ERROR", ec.message());
+    }
+    // Metrics created from now on start fresh
+    loaded.clear();
+    changed = false;
+    savedAt = clock_t::now();
+}
+
+auto Store::find(const std::string& objectPath) const -> const Metric*
+{
+    auto metric = loaded.find(objectPath);
+    return metric != loaded.end() ? &metric->second : nullptr;
+}
+
+void Store::added(const HealthMetric& metric)
+{
+    metrics[metric.getObjectPath()] = &metric;
+    assertions[metric.getObjectPath()] = metric.getAssertionMask();
+}
+
+void Store::updated(const HealthMetric& metric)
+{
+    auto mask = metric.getAssertionMask();
+    auto& last = assertions[metric.getObjectPath()];
+    if (mask != last)
+    {
+        last = mask;
+        changed = true;
+    }
+}
+
+void Store::removed(const HealthMetric& metric)
+{
+    metrics.erase(metric.getObjectPath());
+    assertions.erase(metric.getObjectPath());
+}
+
+void Store::flush()
+{
+    if (changed || clock_t::now() - savedAt >= interval)
+    {
+        save();
+    }
+}
+
+} // namespace phosphor::health::metric::state
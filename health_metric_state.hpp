@@ -0,0 +1,103 @@
+#pragma once
+
+#include "health_metric_config.hpp"
+#include "health_metric_sink.hpp"
+#include "health_rate_limiter.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace phosphor::health::metric::state
+{
+
+using clock_t = std::chrono::steady_clock;
+
+/** @brief Runtime state of a threshold */
+struct Threshold
+{
+    ThresholdIntf::Type type;
+    ThresholdIntf::Bound bound;
+    bool asserted = false;
+    /** @brief Held asserted for flapping */
+    bool flapping = false;
+    clock_t::time_point assertedAt;
+    clock_t::time_point violatedAt;
+    /** @brief Recent assert and deassert transitions */
+    std::vector<clock_t::time_point> transitions;
+};
+
+/** @brief Runtime state of a metric */
+struct Metric
+{
+    /** @brief Sample window, oldest first */
+    std::vector<double> history;
+    double lastTotal = 0;
+    double lastNotifiedValue = 0;
+    std::vector<Threshold> thresholds;
+};
+
+/** @class Store
+ *  @brief Persists the runtime state of the metrics across restarts
+ *
+ *  The sample windows, threshold assertions and rate limiter buckets are
+ *  written at the end of a collection tick once the interval passed, or
+ *  right away when an assertion changed. The state is tied to the boot it
+ *  was written in, as the timestamps are steady clock times.
+ */
+class Store : public MetricSink
+{
+  public:
+    Store() = delete;
+    Store(const Store&) = delete;
+    Store& operator=(const Store&) = delete;
+    Store(Store&&) = delete;
+    Store& operator=(Store&&) = delete;
+
+    Store(std::string file, std::chrono::seconds interval);
+    ~Store() override = default;
+
+    /** @brief Load the state file, false if it is missing, invalid or from
+     *         another boot */
+    auto load() -> bool;
+    /** @brief Write the state of the current metrics */
+    void save();
+
+    /** @brief Get the loaded state of a metric by object path */
+    auto find(const std::string& objectPath) const -> const Metric*;
+    /** @brief Get the loaded rate limiter buckets */
+    auto getRateLimits() const
+        -> const std::vector<ratelimit::RateLimiter::Entry>&
+    {
+        return rateLimits;
+    }
+
+    void added(const HealthMetric& metric) override;
+    void updated(const HealthMetric& metric) override;
+    void removed(const HealthMetric& metric) override;
+    void flush() override;
+
+  private:
+    /** @brief State file */
+    std::string file;
+    /** @brief Minimum time between two writes without assertion changes */
+    std::chrono::seconds interval;
+    /** @brief ID of the current boot */
+    std::string bootId;
+    /** @brief Loaded metric states by object path, until the first write */
+    std::unordered_map<std::string, Metric> loaded;
+    /** @brief Loaded rate limiter buckets */
+    std::vector<ratelimit::RateLimiter::Entry> rateLimits;
+    /** @brief Current metrics by object path */
+    std::unordered_map<std::string, const HealthMetric*> metrics;
+    /** @brief Assertion masks of the current metrics */
+    std::unordered_map<std::string, uint32_t> assertions;
+    /** @brief Set when an assertion changed since the last write */
+    bool changed = false;
+    /** @brief Time of the last write */
+    clock_t::time_point savedAt;
+};
+
+} // namespace phosphor::health::metric::state
@@ -0,0 +1,90 @@
+#include "health_metric_summary.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <chrono>
+
+PHOSPHOR_LOG2_USING;
+
+namespace phosphor::health::metric::summary
+{
+
+static constexpr auto metricsProperty = "Metrics";
+
+const sdbusplus::vtable_t Summary::vtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::property(metricsProperty, "a{s(dut)}",
+                                Summary::getMetrics,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::end()};
+
+Summary::Summary(sdbusplus::bus_t& bus) :
+    summaryInterface(bus, path, interface, vtable, this)
+{
+    summaryInterface.emit_added();
+}
+
+Summary::~Summary()
+{
+    summaryInterface.emit_removed();
+}
+
+int Summary::getMetrics(sd_bus* /*bus*/, const char* /*path*/,
+                        const char* /*interface*/, const char* /*property*/,
+                        sd_bus_message* reply, void* context,
+                        sd_bus_error* retError)
+{
+    auto self = static_cast<Summary*>(context);
+    try
+    {
+        auto msg = sdbusplus::message_t(reply);
+        msg.append(self->metrics);
+    }
+    catch (const std::exception& e)
+    {
+        error("Failed to append summary metrics: {ERROR}", "ERROR", e);
+        return sd_bus_error_set_errno(retError, EIO);
+    }
+    return 1;
+}
+
+void Summary::record(const HealthMetric& metric)
+{
+    uint64_t timestamp =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    metrics[metric.getObjectPath()] = {metric.ValueIntf::value(),
+                                       metric.getAssertionMask(), timestamp};
+    dirty = true;
+}
+
+void Summary::added(const HealthMetric& metric)
+{
+    record(metric);
+}
+
+void Summary::updated(const HealthMetric& metric)
+{
+    record(metric);
+}
+
+void Summary::removed(const HealthMetric& metric)
+{
+    if (metrics.erase(metric.getObjectPath()) > 0)
+    {
+        dirty = true;
+    }
+}
+
+void Summary::flush()
+{
+    if (!dirty)
+    {
+        return;
+    }
+    summaryInterface.property_changed(metricsProperty);
+    dirty = false;
+}
+
+} // namespace phosphor::health::metric::summary
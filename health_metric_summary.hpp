@@ -0,0 +1,67 @@
+#pragma once
+
+#include "health_metric.hpp"
+
+#include <sdbusplus/server/interface.hpp>
+#include <sdbusplus/vtable.hpp>
+
+#include <map>
+#include <string>
+#include <tuple>
+
+namespace phosphor::health::metric::summary
+{
+
+/** @brief D-Bus interface of the summary object */
+static constexpr auto interface = "xyz.openbmc_project.HealthMon.Summary";
+/** @brief D-Bus object path of the summary object */
+static constexpr auto path = "/xyz/openbmc_project/metric/bmc/summary";
+
+/** @class Summary
+ *  @brief Aggregate D-Bus object exposing every metric in one property
+ *
+ *  The Metrics property (a{s(dut)}) maps each metric object path to its
+ *  current value, asserted threshold bitmask (see
+ *  HealthMetric::assertionBit()) and sample time in milliseconds since the
+ *  epoch. Changes are emitted at most once per collection tick.
+ */
+class Summary : public MetricSink
+{
+  public:
+    Summary() = delete;
+    Summary(const Summary&) = delete;
+    Summary& operator=(const Summary&) = delete;
+    Summary(Summary&&) = delete;
+    Summary& operator=(Summary&&) = delete;
+
+    explicit Summary(sdbusplus::bus_t& bus);
+    ~Summary() override;
+
+    void added(const HealthMetric& metric) override;
+    void updated(const HealthMetric& metric) override;
+    void removed(const HealthMetric& metric) override;
+    void flush() override;
+
+  private:
+    using entry_t = std::tuple<double, uint32_t, uint64_t>;
+    using map_t = std::map<std::string, entry_t>;
+
+    /** @brief Property getter for Metrics */
+    static int getMetrics(sd_bus* bus, const char* path, const char* interface,
+                          const char* property, sd_bus_message* reply,
+                          void* context, sd_bus_error* retError);
+    /** @brief Record the current state of a metric */
+    void record(const HealthMetric& metric);
+
+    /** @brief D-Bus vtable of the summary interface */
+    static const sdbusplus::vtable_t vtable[];
+
+    /** @brief Summary D-Bus interface */
+    sdbusplus::server::interface_t summaryInterface;
+    /** @brief Current state by metric object path */
+    map_t metrics;
+    /** @brief Set when a metric changed since the last flush */
+    bool dirty = false;
+};
+
+} // namespace phosphor::health::metric::summary
@@ -3,12 +3,27 @@
 #include "health_monitor.hpp"
 
 #include "health_metric.hpp"
+#include "health_metric_openmetrics.hpp"
+#include "health_metric_shm_writer.hpp"
+#include "health_metric_summary.hpp"
+
+#include <sys/inotify.h>
+#include <unistd.h>
 
 #include <phosphor-logging/lg2.hpp>
 #include <sdbusplus/async.hpp>
+#include <sdbusplus/async/fdio.hpp>
+#include <sdbusplus/bus/match.hpp>
 #include <xyz/openbmc_project/Inventory/Item/Bmc/common.hpp>
 #include <xyz/openbmc_project/Inventory/Item/common.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <string_view>
+
 PHOSPHOR_LOG2_USING;
 
 namespace phosphor::health::monitor
@@ -20,12 +35,8 @@ auto HealthMonitor::startup() -> sdbusplus::async::task<>
     info("Creating Health Monitor with config size {SIZE}", "SIZE",
          configs.size());
 
-    static constexpr auto bmcIntf = sdbusplus::common::xyz::openbmc_project::
-        inventory::item::Bmc::interface;
-    static constexpr auto invPath = sdbusplus::common::xyz::openbmc_project::
-        inventory::Item::namespace_path;
-    auto bmcPaths = co_await findPaths(ctx, bmcIntf, invPath);
-
+    // Metrics are published right away, the BMC associations are added once
+    // the mapper responds, see watchInventory()
     for (auto& [type, collectionConfig] : configs)
     {
         info("Creating Health Metric Collection for {TYPE}", "TYPE", type);
@@ -34,31 +45,335 @@ auto HealthMonitor::startup() -> sdbusplus::async::task<>
                 ctx.get_bus(), type, collectionConfig, bmcPaths);
     }
 
+    for (const auto& source : sources)
+    {
+        if (!source.file.empty())
+        {
+            ctx.spawn(watchConfig(source.file));
+        }
+    }
+    ctx.spawn(watchInventory());
     co_await run();
 }
 
+/** @brief Check if an InterfacesAdded signal, read past the object path,
+ *         adds the given interface */
+static auto addsInterface(sdbusplus::message_t& msg, std::string_view iface)
+    -> bool
+{
+    // Only the interface names are read, the property values may be of any
+    // type
+    auto m = msg.get();
+    if (sd_bus_message_enter_container(m, SD_BUS_TYPE_ARRAY, "{sa{sv}}") <= 0)
+    {
+        return false;
+    }
+    while (sd_bus_message_enter_container(m, SD_BUS_TYPE_DICT_ENTRY,
+                                          "sa{sv}") > 0)
+    {
+        const char* name = nullptr;
+        if (sd_bus_message_read_basic(m, SD_BUS_TYPE_STRING, &name) < 0)
+        {
+            return false;
+        }
+        if (iface == name)
+        {
+            return true;
+        }
+        if (sd_bus_message_skip(m, "a{sv}") < 0 ||
+            sd_bus_message_exit_container(m) < 0)
+        {
+            return false;
+        }
+    }
+    return false;
+}
+
+auto HealthMonitor::watchInventory() -> sdbusplus::async::task<>
+{
+    // Backoff of the mapper query
+    static constexpr auto minMapperRetry = std::chrono::seconds(1);
+    static constexpr auto maxMapperRetry = std::chrono::seconds(60);
+    static constexpr auto bmcIntf = sdbusplus::common::xyz::openbmc_project::
+        inventory::item::Bmc::interface;
+    static constexpr auto invPath = sdbusplus::common::xyz::openbmc_project::
+        inventory::Item::namespace_path;
+    namespace rules = sdbusplus::bus::match::rules;
+
+    // Subscribe before querying the mapper, so that a BMC added meanwhile is
+    // not missed
+    sdbusplus::async::match match(
+        ctx, rules::interfacesAdded() +
+                 rules::argNpath(0, std::string(invPath) + "/"));
+
+    // The mapper may not be up yet, and the BMC items which already exist are
+    // only found by querying it, so retry until it answers
+    auto retryDelay = minMapperRetry;
+    auto paths = co_await findPaths(ctx, bmcIntf, invPath);
+    while (!paths && !ctx.stop_requested())
+    {
+        info("Retrying the BMC inventory query in {DELAY}s", "DELAY",
+             retryDelay.count());
+        co_await sdbusplus::async::sleep_for(ctx, retryDelay);
+        retryDelay = std::min(retryDelay * 2, maxMapperRetry);
+        paths = co_await findPaths(ctx, bmcIntf, invPath);
+    }
+    if (paths)
+    {
+        addBmcPaths(*paths);
+    }
+
+    while (!ctx.stop_requested())
+    {
+        auto msg = co_await match.next();
+        sdbusplus::message::object_path path;
+        try
+        {
+            msg.read(path);
+        }
+        catch (const std::exception& e)
+        {
+            error("Failed to read InterfacesAdded signal: {ERROR}", "ERROR",
+                  e);
+            continue;
+        }
+        if (addsInterface(msg, bmcIntf))
+        {
+            addBmcPaths({path});
+        }
+    }
+}
+
+void HealthMonitor::addBmcPaths(const MetricIntf::paths_t& paths)
+{
+    auto size = bmcPaths.size();
+    for (const auto& path : paths)
+    {
+        if (std::ranges::find(bmcPaths, path) == bmcPaths.end())
+        {
+            bmcPaths.push_back(path);
+        }
+    }
+    if (bmcPaths.size() == size)
+    {
+        return;
+    }
+
+    info("Associating health metrics with {COUNT} BMC inventory paths",
+         "COUNT", bmcPaths.size());
+    for (auto& [type, collection] : collections)
+    {
+        collection->setBmcPaths(bmcPaths);
+    }
+}
+
+auto HealthMonitor::loadConfigs(bool fallback)
+    -> std::optional<ConfigIntf::HealthMetric::map_t>
+{
+    ConfigIntf::HealthMetric::map_t merged;
+    for (const auto& source : sources)
+    {
+        ConfigIntf::HealthMetric::map_t sourceConfigs;
+        try
+        {
+            sourceConfigs = source.load();
+        }
+        catch (const std::exception& e)
+        {
+            error("Invalid health metric config {PATH}: {ERROR}", "PATH",
+                  source.file, "ERROR", e);
+            if (!fallback)
+            {
+                return std::nullopt;
+            }
+            if (source.fallback)
+            {
+                sourceConfigs = source.fallback();
+            }
+        }
+
+        for (auto& [type, configList] : sourceConfigs)
+        {
+            auto& mergedList = merged[type];
+            for (auto& config : configList)
+            {
+                if (std::ranges::find(mergedList, config.name,
+                                      &ConfigIntf::HealthMetric::name) !=
+                    mergedList.end())
+                {
+                    warning("Ignoring duplicate health metric {NAME} from "
+                            "{PATH}",
+                            "NAME", config.name, "PATH", source.file);
+                    continue;
+                }
+                mergedList.emplace_back(std::move(config));
+            }
+        }
+    }
+    return merged;
+}
+
+auto HealthMonitor::watchConfig(std::string configFile)
+    -> sdbusplus::async::task<>
+{
+    auto file = std::filesystem::path(configFile);
+    auto fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+    {
+        auto e = errno;
+        error("Failed to init inotify for {PATH}: {ERROR}", "PATH", configFile,
+              "ERROR", strerror(e));
+        co_return;
+    }
+    // Watch the directory, the file may not exist yet or may be replaced
+    // through a rename by the editor.
+    if (inotify_add_watch(fd, file.parent_path().c_str(),
+                          IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE) < 0)
+    {
+        auto e = errno;
+        info("Not watching {PATH} for changes: {ERROR}", "PATH", configFile,
+             "ERROR", strerror(e));
+        close(fd);
+        co_return;
+    }
+
+    sdbusplus::async::fdio fdio(ctx, fd);
+    alignas(inotify_event) char buffer[4096];
+    while (!ctx.stop_requested())
+    {
+        co_await fdio.next();
+
+        // Drain all pending events so a burst of writes reloads only once
+        bool changed = false;
+        ssize_t length = 0;
+        while ((length = read(fd, buffer, sizeof(buffer))) > 0)
+        {
+            for (auto ptr = buffer; ptr < buffer + length;)
+            {
+                auto event = reinterpret_cast<inotify_event*>(ptr);
+                if (event->len > 0 && file.filename() == event->name)
+                {
+                    changed = true;
+                }
+                ptr += sizeof(inotify_event) + event->len;
+            }
+        }
+        if (changed)
+        {
+            info("Health Monitor config {PATH} changed", "PATH", configFile);
+            reload();
+        }
+    }
+    close(fd);
+}
+
+void HealthMonitor::reload()
+{
+    info("Reloading Health Monitor configs");
+    auto newConfigs = loadConfigs(false);
+    if (!newConfigs)
+    {
+        error("Keeping the current Health Monitor configs");
+        return;
+    }
+
+    try
+    {
+        for (auto it = collections.begin(); it != collections.end();)
+        {
+            if (!newConfigs->contains(it->first))
+            {
+                info("Removing Health Metric Collection for {TYPE}", "TYPE",
+                     it->first);
+                it = collections.erase(it);
+                continue;
+            }
+            ++it;
+        }
+
+        for (auto& [type, collectionConfig] : *newConfigs)
+        {
+            if (auto collection = collections.find(type);
+                collection != collections.end())
+            {
+                collection->second->reconfigure(collectionConfig);
+                continue;
+            }
+            info("Creating Health Metric Collection for {TYPE}", "TYPE", type);
+            collections[type] =
+                std::make_unique<CollectionIntf::HealthMetricCollection>(
+                    ctx.get_bus(), type, collectionConfig, bmcPaths);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        // Some collections may be reconfigured, keep sampling what exists
+        error("Failed to apply the Health Monitor configs: {ERROR}", "ERROR",
+              e);
+    }
+
+    configs = std::move(*newConfigs);
+    publishPlan();
+}
+
 auto HealthMonitor::run() -> sdbusplus::async::task<>
 {
     info("Running Health Monitor");
+    collector = std::make_unique<CollectorIntf::Collector>(
+        std::chrono::seconds(MONITOR_COLLECTION_INTERVAL));
+    publishPlan();
+
+    sdbusplus::async::fdio fdio(ctx, collector->getFd());
     while (!ctx.stop_requested())
     {
-        for (auto& [type, collection] : collections)
+        co_await fdio.next();
+        for (const auto& batch : collector->drain())
+        {
+            apply(batch);
+        }
+    }
+}
+
+void HealthMonitor::apply(const CollectorIntf::Batch& batch)
+{
+    for (const auto& sample : batch.samples)
+    {
+        if (auto collection = collections.find(sample.type);
+            collection != collections.end())
         {
-            debug("Reading Health Metric Collection for {TYPE}", "TYPE", type);
-            collection->read();
+            collection->second->apply(sample);
         }
-        // Checking for Pending Metrics
+    }
+    // Checking for Pending Metrics
+    if (batch.processes)
+    {
         for (auto& [type, collection] : collections)
         {
             if (collection->getPendingConfigsCount() > 0)
             {
                 debug("Pending Metrics found for {TYPE}", "TYPE", type);
-                collection->createPendingConfigs();
+                collection->resolveProcesses(*batch.processes);
             }
         }
-        co_await sdbusplus::async::sleep_for(
-            ctx, std::chrono::seconds(MONITOR_COLLECTION_INTERVAL));
     }
+    MetricIntf::HealthMetric::flushSinks();
+    publishPlan();
+}
+
+void HealthMonitor::publishPlan()
+{
+    if (!collector)
+    {
+        return;
+    }
+    CollectorIntf::Plan plan;
+    for (auto& [type, collection] : collections)
+    {
+        std::ranges::move(collection->sources(),
+                          std::back_inserter(plan.sources));
+        plan.listProcesses |= collection->getPendingConfigsCount() > 0;
+    }
+    collector->publish(std::move(plan));
 }
 } // namespace phosphor::health::monitor
 
@@ -70,18 +385,41 @@ int main()
     sdbusplus::async::context ctx;
     sdbusplus::server::manager_t manager{ctx, path};
     constexpr auto healthMonitorServiceName = "xyz.openbmc_project.HealthMon";
-    phosphor::health::metric::HealthMetric::setBootTime(
-        std::chrono::high_resolution_clock::now());
+    std::unique_ptr<phosphor::health::metric::state::Store> stateStore;
+    if (constexpr std::string_view stateFile = HEALTH_STATE_FILE;
+        !stateFile.empty())
+    {
+        stateStore = std::make_unique<phosphor::health::metric::state::Store>(
+            std::string(stateFile),
+            std::chrono::seconds(HEALTH_STATE_SAVE_INTERVAL));
+        stateStore->load();
+        phosphor::health::metric::HealthMetric::setStore(stateStore.get());
+        phosphor::health::metric::HealthMetric::addSink(*stateStore);
+    }
+    phosphor::health::metric::shm::Writer shmWriter(
+        phosphor::health::metric::shm::defaultName);
+    phosphor::health::metric::HealthMetric::addSink(shmWriter);
+    phosphor::health::metric::batch::Batcher batcher(ctx.get_bus());
+    phosphor::health::metric::HealthMetric::setBatcher(&batcher);
+    phosphor::health::metric::HealthMetric::addSink(batcher);
+    phosphor::health::metric::summary::Summary summary(ctx.get_bus());
+    phosphor::health::metric::HealthMetric::addSink(summary);
+    std::unique_ptr<phosphor::health::metric::openmetrics::Exporter> exporter;
+    if (constexpr std::string_view socketPath = OPENMETRICS_SOCKET_PATH;
+        !socketPath.empty())
+    {
+        exporter =
+            std::make_unique<phosphor::health::metric::openmetrics::Exporter>(
+                ctx, std::string(socketPath));
+        phosphor::health::metric::HealthMetric::addSink(*exporter);
+    }
     info("Creating health monitor");
     using namespace phosphor::health::metric::config;
-    // parseCommonConfig();
-    std::function<HealthMetric::map_t()> healthConfigFunc =
-        getHealthMetricConfigs;
-    HealthMonitor healthMonitor(ctx, healthConfigFunc);
-
-    std::function<HealthMetric::map_t()> srvcConfigFunction =
-        getServiceMetricConfigs;
-    HealthMonitor serviceMonitor(ctx, srvcConfigFunction);
+    // Health and service metrics share one scheduler and collector
+    HealthMonitor healthMonitor(
+        ctx, {{getHealthMetricConfigs, HEALTH_CONFIG_FILE,
+               getDefaultHealthMetricConfigs},
+              {getServiceMetricConfigs, SERVICE_HEALTH_CONFIG_FILE, {}}});
 
     ctx.request_name(healthMonitorServiceName);
 
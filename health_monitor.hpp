@@ -1,31 +1,60 @@
 #pragma once
 
 #include "health_metric_collection.hpp"
+#include "health_metric_collector.hpp"
 
 #include <sdbusplus/async.hpp>
 
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace phosphor::health::monitor
 {
 namespace ConfigIntf = phosphor::health::metric::config;
 namespace MetricIntf = phosphor::health::metric;
 namespace CollectionIntf = phosphor::health::metric::collection;
+namespace CollectorIntf = phosphor::health::metric::collector;
+
+/** @brief Metric configs and the file they are loaded from */
+struct ConfigSource
+{
+    /** @brief Function to (re)load the configs */
+    std::function<ConfigIntf::HealthMetric::map_t()> load;
+    /** @brief Config file watched for changes, empty to disable reload */
+    std::string file;
+    /** @brief Configs used if load() throws at startup, none if empty */
+    std::function<ConfigIntf::HealthMetric::map_t()> fallback;
+};
+
+/** @class HealthMonitor
+ *  @brief Samples the metrics of one or more config sources
+ *
+ *  The configs of all sources are merged, so the health and service metrics
+ *  share a single collection per type, mapper query, collector thread and
+ *  /proc scan, and wake up together.
+ */
 class HealthMonitor
 {
   public:
     HealthMonitor() = delete;
 
     HealthMonitor(sdbusplus::async::context& ctx) :
-        ctx(ctx), configs(ConfigIntf::getHealthMetricConfigs())
-    {
-        ctx.spawn(startup());
-    }
+        HealthMonitor(ctx, {{ConfigIntf::getHealthMetricConfigs, "",
+                             ConfigIntf::getDefaultHealthMetricConfigs}})
+    {}
     HealthMonitor(
         sdbusplus::async::context& ctx,
-        std::function<ConfigIntf::HealthMetric::map_t()> configFunction) :
-        ctx(ctx),
-        configs(configFunction())
+        std::function<ConfigIntf::HealthMetric::map_t()> configFunction,
+        const std::string& configFile = "") :
+        HealthMonitor(ctx, {{configFunction, configFile, {}}})
+    {}
+    HealthMonitor(sdbusplus::async::context& ctx,
+                  std::vector<ConfigSource> sources) :
+        ctx(ctx), sources(std::move(sources)), configs(*loadConfigs(true))
     {
         ctx.spawn(startup());
     }
@@ -33,8 +62,29 @@ class HealthMonitor
   private:
     /** @brief Setup and run a new health monitor object */
     auto startup() -> sdbusplus::async::task<>;
-    /** @brief Run the health monitor */
+    /** @brief Run the health monitor, consuming the collector batches */
     auto run() -> sdbusplus::async::task<>;
+    /** @brief Apply a batch of samples to the metrics */
+    void apply(const CollectorIntf::Batch& batch);
+    /** @brief Publish the metrics to sample to the collector */
+    void publishPlan();
+    /** @brief Query the BMC inventory paths from the mapper and watch for
+     *         BMC inventory items added later */
+    auto watchInventory() -> sdbusplus::async::task<>;
+    /** @brief Add BMC inventory paths and update the metric associations */
+    void addBmcPaths(const MetricIntf::paths_t& paths);
+    /** @brief Watch a config file and reload on change */
+    auto watchConfig(std::string configFile) -> sdbusplus::async::task<>;
+    /** @brief Load and merge the configs of all sources
+     *
+     *  An invalid source is replaced by its fallback configs if fallback is
+     *  set, otherwise nothing is returned.
+     */
+    auto loadConfigs(bool fallback)
+        -> std::optional<ConfigIntf::HealthMetric::map_t>;
+    /** @brief Reload the configs and apply the difference, the current
+     *         configs are kept if any source is invalid */
+    void reload();
 
     using map_t = std::unordered_map<
         MetricIntf::Type,
@@ -42,9 +92,15 @@ class HealthMonitor
 
     /** @brief D-Bus context */
     sdbusplus::async::context& ctx;
-    /** @brief Health metric configs */
+    /** @brief Sources of the health metric configs */
+    std::vector<ConfigSource> sources;
+    /** @brief Merged health metric configs */
     ConfigIntf::HealthMetric::map_t configs;
     map_t collections;
+    /** @brief BMC inventory paths for the metric associations */
+    MetricIntf::paths_t bmcPaths;
+    /** @brief Collector thread, started once the collections exist */
+    std::unique_ptr<CollectorIntf::Collector> collector;
 };
 
 } // namespace phosphor::health::monitor
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <xyz/openbmc_project/Common/Threshold/common.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <compare>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace phosphor::health::ratelimit
+{
+
+using Threshold =
+    sdbusplus::common::xyz::openbmc_project::common::Threshold;
+using clock_t = std::chrono::steady_clock;
+
+/** @brief Rate limit of a threshold action */
+struct Limit
+{
+    /** @brief Number of actions which may be taken back to back */
+    double burst = 1;
+    /** @brief Time to earn one more action, 0 disables the limit */
+    std::chrono::seconds period{0};
+};
+
+/** @brief Identity of a rate limited action */
+struct Key
+{
+    std::string metric;
+    Threshold::Type type;
+    Threshold::Bound bound;
+    std::string target;
+
+    auto operator<=>(const Key&) const = default;
+};
+
+/** @class TokenBucket
+ *  @brief Token bucket, starts full and earns one token per period
+ */
+class TokenBucket
+{
+  public:
+    TokenBucket() = default;
+    /** @brief Restore a bucket which was last used at the given time */
+    TokenBucket(double tokens, clock_t::time_point last) :
+        tokens(tokens), last(last), started(true)
+    {}
+
+    /** @brief Take a token if one is available */
+    auto take(const Limit& limit, clock_t::time_point now) -> bool
+    {
+        tokens = available(limit, now);
+        last = now;
+        started = true;
+        if (tokens < 1)
+        {
+            return false;
+        }
+        tokens -= 1;
+        return true;
+    }
+
+    /** @brief Check if the bucket refilled completely, so that dropping it
+     *         does not change any later decision */
+    auto full(const Limit& limit, clock_t::time_point now) const -> bool
+    {
+        return available(limit, now) >= limit.burst;
+    }
+
+    /** @brief Tokens left after the last use */
+    auto getTokens() const -> double
+    {
+        return tokens;
+    }
+    /** @brief Time of the last use */
+    auto getLast() const -> clock_t::time_point
+    {
+        return last;
+    }
+
+  private:
+    /** @brief Tokens available at the given time */
+    auto available(const Limit& limit, clock_t::time_point now) const
+        -> double
+    {
+        if (!started || limit.period.count() <= 0)
+        {
+            return limit.burst;
+        }
+        std::chrono::duration<double> elapsed = now - last;
+        return std::min(limit.burst,
+                        tokens + elapsed / std::chrono::duration<double>(
+                                               limit.period));
+    }
+
+    double tokens = 0;
+    clock_t::time_point last;
+    bool started = false;
+};
+
+/** @class RateLimiter
+ *  @brief Token buckets keyed by metric, threshold and target
+ *
+ *  Buckets are created on first use. Once the number of buckets reaches a
+ *  high-water mark, buckets which refilled completely are dropped, as a new
+ *  bucket behaves exactly the same.
+ */
+class RateLimiter
+{
+  public:
+    /** @brief State of a bucket, to persist it across restarts */
+    struct Entry
+    {
+        Key key;
+        Limit limit;
+        double tokens;
+        clock_t::time_point last;
+    };
+
+    /** @brief Check if the action for key may be taken now, and account
+     *         for it if so */
+    auto allow(const Key& key, const Limit& limit,
+               clock_t::time_point now = clock_t::now()) -> bool
+    {
+        if (limit.period.count() <= 0)
+        {
+            return true;
+        }
+        if (buckets.size() >= pruneAt)
+        {
+            prune(now);
+        }
+        auto& [bucketLimit, bucket] = buckets[key];
+        bucketLimit = limit;
+        return bucket.take(limit, now);
+    }
+
+    /** @brief Number of tracked buckets */
+    auto size() const -> size_t
+    {
+        return buckets.size();
+    }
+
+    /** @brief Get the state of the buckets which did not refill yet */
+    auto entries(clock_t::time_point now = clock_t::now()) const
+        -> std::vector<Entry>
+    {
+        std::vector<Entry> result;
+        for (const auto& [key, value] : buckets)
+        {
+            const auto& [limit, bucket] = value;
+            if (!bucket.full(limit, now))
+            {
+                result.push_back(
+                    {key, limit, bucket.getTokens(), bucket.getLast()});
+            }
+        }
+        return result;
+    }
+
+    /** @brief Restore buckets saved by entries() */
+    void restore(const std::vector<Entry>& saved)
+    {
+        for (const auto& entry : saved)
+        {
+            buckets.insert_or_assign(
+                entry.key, std::make_pair(entry.limit,
+                                          TokenBucket(entry.tokens,
+                                                      entry.last)));
+        }
+        pruneAt = std::max(pruneAt, buckets.size() * 2);
+    }
+
+  private:
+    void prune(clock_t::time_point now)
+    {
+        std::erase_if(buckets, [now](const auto& entry) {
+            const auto& [limit, bucket] = entry.second;
+            return bucket.full(limit, now);
+        });
+        pruneAt = std::max(minPruneAt, buckets.size() * 2);
+    }
+
+    static constexpr size_t minPruneAt = 256;
+    size_t pruneAt = minPruneAt;
+    std::map<Key, std::pair<Limit, TokenBucket>> buckets;
+};
+
+} // namespace phosphor::health::ratelimit
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace phosphor::health::ring
+{
+
+/** @class Ring
+ *  @brief Lock-free ring buffer for a single producer and a single consumer
+ */
+template <typename T, size_t N>
+class Ring
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "N must be a power of two");
+
+  public:
+    /** @brief Add an item, false if the ring is full. Producer only. */
+    auto push(T&& item) -> bool
+    {
+        auto current = head.load(std::memory_order_relaxed);
+        if (current - tail.load(std::memory_order_acquire) == N)
+        {
+            return false;
+        }
+        slots[current & (N - 1)] = std::move(item);
+        head.store(current + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** @brief Take the oldest item, false if the ring is empty. Consumer
+     *         only. */
+    auto pop(T& item) -> bool
+    {
+        auto current = tail.load(std::memory_order_relaxed);
+        if (current == head.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        item = std::move(slots[current & (N - 1)]);
+        tail.store(current + 1, std::memory_order_release);
+        return true;
+    }
+
+  private:
+    std::array<T, N> slots;
+    /** @brief Next slot to write, only written by the producer */
+    alignas(64) std::atomic<size_t> head{0};
+    /** @brief Next slot to read, only written by the consumer */
+    alignas(64) std::atomic<size_t> tail{0};
+};
+
+} // namespace phosphor::health::ring
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <time.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+namespace phosphor::health::utils
+{
+
+/** @brief Get the time since the system booted, from CLOCK_BOOTTIME, 0 if
+ *         it cannot be read
+ *
+ *  CLOCK_BOOTTIME keeps counting while suspended and is not reset when the
+ *  daemon restarts. Shared by the health and IPC monitors.
+ */
+inline auto getUptime() -> std::chrono::seconds
+{
+    timespec now{};
+    if (clock_gettime(CLOCK_BOOTTIME, &now) != 0)
+    {
+        lg2::error("Failed to read CLOCK_BOOTTIME: {ERROR}", "ERROR",
+                   strerror(errno));
+        return std::chrono::seconds(0);
+    }
+    return std::chrono::seconds(now.tv_sec);
+}
+
+} // namespace phosphor::health::utils
@@ -9,6 +9,7 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <string_view>
 PHOSPHOR_LOG2_USING;
 
 namespace phosphor::health::utils
@@ -60,8 +61,11 @@ void startUnit(sdbusplus::bus_t& bus, const std::string& sysdUnit,
 }
 
 auto findPaths(sdbusplus::async::context& ctx, const std::string& iface,
-               const std::string& subpath) -> sdbusplus::async::task<paths_t>
+               const std::string& subpath)
+    -> sdbusplus::async::task<std::optional<paths_t>>
 {
+    static constexpr auto resourceNotFound =
+        "xyz.openbmc_project.Common.Error.ResourceNotFound";
     try
     {
         using ObjectMapper =
@@ -74,12 +78,22 @@ auto findPaths(sdbusplus::async::context& ctx, const std::string& iface,
         std::vector<std::string> ifaces = {iface};
         co_return co_await mapper.get_sub_tree_paths(subpath, 0, ifaces);
     }
-    catch (std::exception& e)
+    catch (const sdbusplus::exception_t& e)
     {
+        // The mapper answered, there is nothing under the subpath yet
+        if (std::string_view(e.name()) == resourceNotFound)
+        {
+            co_return paths_t{};
+        }
         error("Exception occurred for GetSubTreePaths for {PATH}: {ERROR}",
               "PATH", subpath, "ERROR", e);
     }
-    co_return {};
+    catch (const std::exception& e)
+    {
+        error("Exception occurred for GetSubTreePaths for {PATH}: {ERROR}",
+              "PATH", subpath, "ERROR", e);
+    }
+    co_return std::nullopt;
 }
 
 bool containsOnlyDigits(const std::string& str)
@@ -115,6 +129,14 @@ int getNumberofCPU()
     }
     return cpus;
 }
+
+auto getBootId() -> std::string
+{
+    std::ifstream file("/proc/sys/kernel/random/boot_id");
+    std::string bootId;
+    std::getline(file, bootId);
+    return bootId;
+}
 void createThresholdLogEntry(sdbusplus::bus_t& bus, Threshold::Type& type,
                              Threshold::Bound& bound,
                              const std::string& sensorName, double value,
@@ -1,11 +1,17 @@
 #pragma once
 
+#include "health_uptime.hpp"
+
 #include <sdbusplus/async.hpp>
 #include <sdbusplus/bus.hpp>
 #include <sdbusplus/sdbus.hpp>
 #include <xyz/openbmc_project/Common/Threshold/server.hpp>
 
+#include <chrono>
+#include <optional>
+#include <string>
 #include <vector>
+
 namespace phosphor::health::utils
 {
 
@@ -16,9 +22,11 @@ void startUnit(sdbusplus::bus_t& bus, const std::string& sysdUnit,
                const std::string resource, const std::string path = "",
                const std::string binaryname = "", const double usage = 0.0);
 
-/** @brief Find D-Bus paths for given interface */
+/** @brief Find D-Bus paths for given interface, nothing if the mapper could
+ *         not be queried */
 auto findPaths(sdbusplus::async::context& ctx, const std::string& iface,
-               const std::string& subpath) -> sdbusplus::async::task<paths_t>;
+               const std::string& subpath)
+    -> sdbusplus::async::task<std::optional<paths_t>>;
 
 void createThresholdLogEntry(sdbusplus::bus_t& bus, Threshold::Type& type,
                              Threshold::Bound& bound,
@@ -38,4 +46,7 @@ int getSystemClockFrequency();
 
 /** @brief Get the number of CPUs */
 int getNumberofCPU();
+
+/** @brief Get the ID of the current boot, empty if unavailable */
+auto getBootId() -> std::string;
 } // namespace phosphor::health::utils
@@ -1,16 +1,16 @@
 #include "dbusIpcSensor.hpp"
 
-#include "asio_connection.hpp"
-
 #include <nlohmann/json.hpp>
 #include <phosphor-logging/lg2.hpp>
-#include <sdbusplus/bus.hpp>
 #include <sdbusplus/message.hpp>
 
-#include <filesystem>
+#include <cmath>
+#include <limits>
 #include <memory>
-#include <regex>
-#include <tuple>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <variant>
 // Implement the DBusIpcSensor class
 namespace phosphor
 {
@@ -19,43 +19,14 @@ namespace ipc
 
 PHOSPHOR_LOG2_USING;
 
-// Get statistics implementation
-// Define the variant type that can hold any type. In practice, you would extend
-// this to include all the types you expect to handle.
-using VariantType =
-    std::variant<unsigned int, double, std::string>; // Example variant types
-
-// Define the type for 'a{sv}', an array of dictionaries with string keys and
-// variant values.
-using StringAndVariantType = std::map<std::string, VariantType>;
-
-// Define the type for 'a{su}', an array of dictionaries with string keys and
-// unsigned integer values.
-using StringAndUnsignedType = std::map<std::string, unsigned int>;
-
-// Finally, define the type for 'a(sa{sv}a{su})', which is an array of tuples.
-// Each tuple contains a string, a StringAndVariantType, and a
-// StringAndUnsignedType.
-using PeerAccountingType = std::vector<
-    std::tuple<std::string, StringAndVariantType, StringAndUnsignedType>>;
-
-// GetStats returns a{sv} where v variant is of type a(sa{sv}a{su})
-// therefore std::map<std::string, std::variant<ComplexDBusType>>
-
 // Read data implementation
 void DBusIpcSensor::readSensor()
 {
-    auto& connObject = AsioConnection::getAsioConnection();
-    if (connObject == nullptr)
-    {
-        lg2::error("Connection object is null");
-        return;
-    }
     // DBus implementation of Debug/Stats
     // Make call to DBus Debug Service to get stats
-    connObject->async_method_call(
+    conn.async_method_call(
         [this](const boost::system::error_code ec,
-               std::map<std::string, std::variant<PeerAccountingType>>& resp) {
+               sdbusplus::message_t& reply) {
         asyncResp.clear();
         if (ec)
         {
@@ -63,57 +34,58 @@ void DBusIpcSensor::readSensor()
             lg2::error("GetStats resp_handler got error");
             return;
         }
-        // GetStats returns a{sv} where v variant is of type a(sa{sv}a{su})
-        // Here stat is e.g. org.bus1.DBus.Debug.Stats.PeerAccounting or
-        // "org.bus1.DBus.Debug.Stats.UserAccounting" and type is a tuple of
+        // GetStats returns a{sv}, whose
+        // org.bus1.DBus.Debug.Stats.PeerAccounting entry is an array of
         // service name, DictionaryOfStringAndVariant and
-        // DictionaryOfStringAndUnsigned
-        for (auto& [stat, type] : resp)
-        {
-            if (stat != "org.bus1.DBus.Debug.Stats.PeerAccounting")
-            {
-                continue;
-            }
-
-            for (auto& tuple : std::get<PeerAccountingType>(type))
+        // DictionaryOfStringAndUnsigned. The decoder only reads the
+        // configured counters, e.g. "OutgoingBytes" and "IncomingBytes",
+        // in paramConfig order.
+        auto now = std::chrono::steady_clock::now();
+        std::unordered_map<std::string, Snapshot> current;
+        auto decoded = decoder.decode(
+            reply.get(),
+            [&](std::string_view peer, StatsDecoder::counters_t counters) {
+            std::string connectionName(peer);
+            std::vector<std::pair<size_t, double>> stats;
+            auto& snapshot = current[connectionName];
+            snapshot.time = now;
+            for (size_t index = 0; index < counters.size(); index++)
             {
-                std::string connectionName = std::get<0>(tuple);
-                if (std::get<2>(tuple).size() > 0)
+                if (!counters[index])
                 {
-                    // reading a{su} type 'data' type is
-                    // std::map<std::string, unsigned int>
-                    auto& data = std::get<2>(tuple);
-                    std::vector<
-                        std::pair<std::string,
-                                  std::variant<long int, double, std::string>>>
-                        stats;
-                    // statistics is configured with <"Outgoingbytes",
-                    // int>  and <"Incomingbytes", int>
-                    for (auto& configuredStat : statistics)
-                    {
-                        // Here dbus return type as 'a{su}' therefore
-                        // 'data' type is std::map<std::string, unsigned
-                        // int> finding the key in the map
-                        auto it = data.find(configuredStat.first);
-                        if (it != data.end())
-                        {
-                            long int value = static_cast<long int>(it->second);
-                            stats.push_back(
-                                std::make_pair(configuredStat.first, value));
-                        }
-                    }
-                    // Insert the service name and stats into the map
-                    asyncResp.insert(std::make_pair(connectionName, stats));
-                    stats.clear();
+                    continue;
+                }
+                const auto& param = ipcConfig.paramConfig[index];
+                auto counter = *counters[index];
+                if (!param.rate)
+                {
+                    stats.emplace_back(index, counter);
+                    continue;
+                }
+                snapshot.counters[param.key] = counter;
+                if (auto rate = getGrowth(connectionName, param.key, counter,
+                                          now))
+                {
+                    stats.emplace_back(index, *rate);
                 }
             }
-            if (asyncResp.size() > 0)
-            {
-                // storing asyncResp as class member to avoid copy
-                // elison Therefore no need to copy the asyncResp map to
-                // process the data
-                processdata();
-            }
+            // Insert the service name and stats into the map
+            asyncResp.emplace(std::move(connectionName), std::move(stats));
+        });
+        if (!decoded)
+        {
+            lg2::error("Failed to decode the GetStats reply");
+            asyncResp.clear();
+            return;
+        }
+        // Peers which disconnected are dropped
+        snapshots = std::move(current);
+        if (asyncResp.size() > 0)
+        {
+            // storing asyncResp as class member to avoid copy
+            // elison Therefore no need to copy the asyncResp map to
+            // process the data
+            processdata();
         }
     },
         "org.freedesktop.DBus", "/org/freedesktop/DBus",
@@ -123,164 +95,162 @@ void DBusIpcSensor::readSensor()
 // Process statistic data implementation
 void DBusIpcSensor::processdata()
 {
-    // std::map<std::string, std::vector<std::pair<std::string,
-    // std::variant<long int,double,std::string>>>> asyncResp;
+    // asyncResp holds the parameter index and value of the monitored
+    // counters and rates of every peer
+    // Peers missing from this read disconnected and are evicted below
+    peers.beginGeneration();
+    resolveUnits();
+    bool full = false;
     for (auto& [connName, sensorValue] : asyncResp)
     {
-        for (auto& [key, value] : sensorValue)
+        auto id = peers.intern(connName);
+        if (!id)
         {
-            auto it = std::find_if(
-                ipcConfig.paramConfig.begin(), ipcConfig.paramConfig.end(),
-                [key](const auto& param) { return param.key == key; });
-            if (it != ipcConfig.paramConfig.end())
-            {
-                if (it->valueType == "int")
-                {
-                    if (std::holds_alternative<long int>(value))
-                    {
-                        long int val = std::get<long int>(value);
-
-                        using ConnKeyType = std::pair<std::string, std::string>;
-                        ConnKeyType connKey = std::make_pair(connName, key);
-
-                        if (val > it->warningHigh ||
-                            valQueueMap.find(connKey) != valQueueMap.end())
-                        {
-                            /* find property already exist in queue */
-                            if (valQueueMap.find(connKey) == valQueueMap.end())
-                            {
-                                valQueueMap[connKey] = std::deque<
-                                    std::variant<long int, double>>();
-                            }
-
-                            auto& queue = valQueueMap[connKey];
-                            if (queue.size() >= ipcConfig.windowSize)
-                            {
-                                queue.pop_front();
-                            }
-                            /* Add new item at the back */
-                            queue.push_back(val);
-
-                            /* Wait until the queue is filled with enough
-                             * reference*/
-                            if (queue.size() < ipcConfig.windowSize)
-                            {
-                                continue;
-                            }
+            full = true;
+            continue;
+        }
+        for (size_t param = 0; param < ipcConfig.paramConfig.size(); param++)
+        {
+            peers.state(*id, param).value =
+                std::numeric_limits<double>::quiet_NaN();
+        }
+        for (auto [index, val] : sensorValue)
+        {
+            const auto& cfg = ipcConfig.paramConfig[index];
+            auto& state = peers.state(*id, index);
+            state.value = val;
 
-                            /* Calculate average values for the given window
-                             * size */
-                            double avgValue = 0;
-                            // Custom accumulate operation
-                            avgValue = std::accumulate(
-                                queue.begin(), queue.end(), avgValue,
-                                [](double acc,
-                                   const std::variant<long int, double>& val)
-                                    -> double {
-                                // Visit the variant to handle each possible
-                                // type
-                                return acc + std::visit(
-                                                 [](auto&& arg) -> double {
-                                    using T = std::decay_t<decltype(arg)>;
-                                    if constexpr (std::is_same_v<T, long int>)
-                                    {
-                                        // If the variant holds a numeric type,
-                                        // add it to the accumulator
-                                        return arg;
-                                    }
-                                    else
-                                    {
-                                        // If the variant holds a non-numeric
-                                        // type, add zero
-                                        return 0;
-                                    }
-                                },
-                                                 val);
-                            });
-                            avgValue = avgValue / ipcConfig.windowSize;
-                            if (avgValue < it->warningHigh)
-                            {
-                                lg2::info(
-                                    "Average value for {SERVICE} is {VALUE} less than warning threshold, therefore removing it",
-                                    "SERVICE", connName, "VALUE", avgValue);
-                                lg2::info("key is {KEY}", "KEY", key);
-                                valQueueMap.erase(connKey);
-                                if (logStatusMap.find(connKey) !=
-                                    logStatusMap.end())
-                                {
-                                    logStatusMap.erase(connKey);
-                                }
-                                continue;
-                            }
-                            /* Check the sensor threshold  and log required
-                             * message
-                             */
-                            checkSensorThreshold(avgValue, connName, *it);
-                        }
-                    }
+            // The window only fills while the value crosses the warning
+            auto crossed = cfg.predicate(val, cfg.warningHigh);
+            auto avgValue = std::visit(
+                [crossed, val](auto& window) -> std::optional<double> {
+                if (!crossed && window.empty())
+                {
+                    return std::nullopt;
+                }
+                using value_t =
+                    typename std::decay_t<decltype(window)>::value_type;
+                window.push(static_cast<value_t>(val));
+                /* Wait until the window is filled with enough reference */
+                if (!window.full())
+                {
+                    return std::nullopt;
                 }
+                return window.average();
+            },
+                state.window);
+            if (!avgValue)
+            {
+                continue;
             }
+
+            if (!cfg.predicate(*avgValue, cfg.warningHigh))
+            {
+                lg2::info(
+                    "Average value for {SERVICE} is {VALUE} within the warning threshold, therefore removing it",
+                    "SERVICE", connName, "VALUE", *avgValue);
+                lg2::info("key is {KEY}", "KEY", cfg.name);
+                std::visit([](auto& window) { window.clear(); }, state.window);
+                state.warningLogged = false;
+                state.criticalLogged = false;
+                state.warningAsserted = false;
+                state.criticalAsserted = false;
+                continue;
+            }
+            state.warningAsserted = true;
+            state.criticalAsserted = cfg.predicate(*avgValue, cfg.criticalHigh);
+            /* Check the sensor threshold  and log required message */
+            checkSensorThreshold(*avgValue, connName, cfg);
         }
     }
+    publishUnits();
+    if (full)
+    {
+        lg2::warning("IPC sensor {IPC} tracks {COUNT} peers, ignoring new ones",
+                     "IPC", ipcConfig.name, "COUNT", peers.size());
+    }
+    if (auto evicted = peers.sweep(); evicted > 0)
+    {
+        lg2::debug("IPC sensor {IPC} evicted {COUNT} disconnected peers", "IPC",
+                   ipcConfig.name, "COUNT", evicted);
+    }
 }
 
-// Get unit name for connection name implementation
-template <typename CallbackFn>
-void DBusIpcSensor::convertConnectionToUnit(const std::string& connName,
-                                            CallbackFn&& callback)
+void DBusIpcSensor::resolveUnits()
 {
-    auto& connObject = AsioConnection::getAsioConnection();
-    if (connObject == nullptr)
+    // Lookups which fail are not retried while the peer stays connected
+    for (const auto& [connName, stats] : asyncResp)
     {
-        lg2::error("Connection object is null");
-        return;
-    }
-    // DBus implementation of Debug/Stats
-    // Make call to DBus Debug Service to get stats
-    connObject->async_method_call(
-        [this, &connObject, callback = std::forward<CallbackFn>(callback)](
-            const boost::system::error_code ec, unsigned int pid) {
-        if (ec)
+        if (!peerUnits.try_emplace(connName).second)
         {
-            // TODO: Handle for specific error code
-            lg2::error("GetConnectionUnixProcessID resp_handler got error");
-            return;
+            continue;
         }
-        connObject->async_method_call(
-            [this, callback = std::move(callback),
-             pid](const boost::system::error_code ec,
-                  sdbusplus::message::object_path path) {
-            if (ec)
+        unitResolver.resolve(connName,
+                             [this, connName](const std::string& unit) {
+            if (auto peer = peerUnits.find(connName); peer != peerUnits.end())
             {
-                // TODO: Handle for specific error code
-                lg2::error("GetUnitByPID resp_handler got error ");
-                return;
+                peer->second = unit;
             }
-            std::string unit(path);
-            if (unit.empty())
+        });
+    }
+    std::erase_if(peerUnits, [this](const auto& peer) {
+        return !asyncResp.contains(peer.first);
+    });
+}
+
+void DBusIpcSensor::publishUnits()
+{
+    for (const auto& [connName, unit] : peerUnits)
+    {
+        auto id = peers.find(connName);
+        if (!unit || !id)
+        {
+            continue;
+        }
+        for (size_t param = 0; param < ipcConfig.paramConfig.size(); param++)
+        {
+            const auto& state = peers.state(*id, param);
+            if (std::isnan(state.value))
             {
-                lg2::error("Not able to find unit name for PID: {PID}", "PID",
-                           pid);
-                return;
+                continue;
             }
-            // e.g. unit obect path looks like
-            // /org/freedesktop/systemd1/unit/phosphor_2dcertificate_2dmanager_40bmcweb_2eservice
-            std::filesystem::path p(unit);
-            std::string unitName = p.filename();
-            // Replace encoded characters in the unit name
-            // e.g. phosphor_2dcertificate_2dmanager_40bmcweb_2eservice
-            unitName = std::regex_replace(unitName, std::regex("_2e"), ".");
-            unitName = std::regex_replace(unitName, std::regex("_2d"), "-");
-            unitName = std::regex_replace(unitName, std::regex("_5f"), "_");
-            unitName = std::regex_replace(unitName, std::regex("_40"), "@");
-            lg2::info("Unit name: {UNIT}", "UNIT", unitName);
-            callback(unitName);
-        },
-            "org.freedesktop.systemd1", "/org/freedesktop/systemd1",
-            "org.freedesktop.systemd1.Manager", "GetUnitByPID", pid);
-    },
-        "org.freedesktop.DBus", "/org/freedesktop/DBus", "org.freedesktop.DBus",
-        "GetConnectionUnixProcessID", connName);
+            unitMetrics.add(*unit, param, state.value, state.warningAsserted,
+                            state.criticalAsserted);
+        }
+    }
+    unitMetrics.commit();
+}
+
+auto DBusIpcSensor::findState(const std::string& connName,
+                              const std::string& paramName) -> ParamState*
+{
+    auto id = peers.find(connName);
+    auto param = paramIndex.find(paramName);
+    if (!id || param == paramIndex.end())
+    {
+        return nullptr;
+    }
+    return &peers.state(*id, param->second);
+}
+
+auto DBusIpcSensor::getGrowth(const std::string& connName,
+                              const std::string& key, unsigned int value,
+                              std::chrono::steady_clock::time_point now) const
+    -> std::optional<double>
+{
+    auto snapshot = snapshots.find(connName);
+    if (snapshot == snapshots.end())
+    {
+        return std::nullopt;
+    }
+    auto previous = snapshot->second.counters.find(key);
+    if (previous == snapshot->second.counters.end())
+    {
+        // First read of the counter
+        return std::nullopt;
+    }
+    return getQueueGrowth(previous->second, value,
+                          now - snapshot->second.time);
 }
 
 // Callback function to handle logging and start unit
@@ -290,38 +260,46 @@ void DBusIpcSensor::logAndExecuteAction(const std::string connName,
                                         const double value,
                                         const std::string unitName)
 {
-    using ConnKeyType = std::pair<std::string, std::string>;
-    ConnKeyType connKey = std::make_pair(connName, paramConfig.key);
+    // The peer may have disconnected or dropped below warning meanwhile
+    auto state = findState(connName, paramConfig.name);
+    if (state != nullptr && state->windowEmpty())
+    {
+        state = nullptr;
+    }
+    // Limited by unit, whose connection name changes when it restarts
+    using Threshold = health::ratelimit::Threshold;
+    auto type = thresholdType == "critical" ? Threshold::Type::Critical
+                                            : Threshold::Type::Warning;
+    if (!allowAction(unitName, paramConfig, type))
+    {
+        lg2::debug("{TYPE} action for {UNIT} {KEY} is rate limited", "TYPE",
+                   thresholdType, "UNIT", unitName, "KEY", paramConfig.name);
+        return;
+    }
     if (thresholdType == "critical")
     {
         lg2::info("Creating threshold log entry for critical");
-        createThresholdLogEntry("critical", unitName, paramConfig.key, value,
+        createThresholdLogEntry("critical", unitName, paramConfig.name, value,
                                 paramConfig.criticalHigh);
         startUnit(paramConfig.criticalTgt, unitName,
                   "CriticalThresholdLimitCrossed");
-        if (logStatusMap.find(connKey) != logStatusMap.end())
+        if (state != nullptr && !state->criticalLogged)
         {
-            if (!logStatusMap[connKey].second)
-            {
-                logStatusMap[connKey].second = true;
-                lg2::info("Updating Critical log status to {STATUS}", "STATUS",
-                          logStatusMap[connKey].second);
-            }
+            state->criticalLogged = true;
+            lg2::info("Updating Critical log status to {STATUS}", "STATUS",
+                      state->criticalLogged);
         }
     }
     else if (thresholdType == "warning")
     {
         lg2::info("Creating threshold log entry for warning");
-        createThresholdLogEntry("warning", unitName, paramConfig.key, value,
+        createThresholdLogEntry("warning", unitName, paramConfig.name, value,
                                 paramConfig.warningHigh);
-        if (logStatusMap.find(connKey) != logStatusMap.end())
+        if (state != nullptr && !state->warningLogged)
         {
-            if (!logStatusMap[connKey].first)
-            {
-                logStatusMap[connKey].first = true;
-                lg2::info("Updating Warning log status to {STATUS}", "STATUS",
-                          logStatusMap[connKey].first);
-            }
+            state->warningLogged = true;
+            lg2::info("Updating Warning log status to {STATUS}", "STATUS",
+                      state->warningLogged);
         }
     }
 }
@@ -335,84 +313,60 @@ void DBusIpcSensor::init()
 // Overide checkSensorThreshold implementation
 void DBusIpcSensor::checkSensorThreshold(const double value,
                                          const std::string& connName,
-                                         struct ParamConfig paramConfig)
+                                         const struct ParamConfig& paramConfig)
 {
-    using ConnKeyType = std::pair<std::string, std::string>;
-    ConnKeyType connKey = std::make_pair(connName, paramConfig.key);
-    if (std::isfinite(paramConfig.criticalHigh) &&
-        (paramConfig.operatorType == "greater_than") &&
-        (value > paramConfig.criticalHigh))
+    auto state = findState(connName, paramConfig.name);
+    if (paramConfig.predicate(value, paramConfig.criticalHigh))
     {
         lg2::error(
-            "ASSERT: Dbus connection {SERVICE} is above the upper threshold critical high and value is {VALUE}",
-            "SERVICE", connName, "VALUE", value);
+            "ASSERT: Dbus connection {SERVICE} is {OPERATOR} the critical threshold and value is {VALUE}",
+            "SERVICE", connName, "OPERATOR", paramConfig.predicate.describe(),
+            "VALUE", value);
 
-        bool criticalLogStatus = false;
-        if (logStatusMap.find(connKey) != logStatusMap.end())
-        {
-            criticalLogStatus = logStatusMap[connKey].second;
-        }
-        else
-        {
-            // Insert the connection key and log status for fitrst time
-            logStatusMap[connKey] = std::make_pair(false, false);
-        }
+        bool criticalLogStatus = state != nullptr && state->criticalLogged;
 
         if (!criticalLogStatus)
         {
             auto callback = std::bind_front(&DBusIpcSensor::logAndExecuteAction,
                                             this, connName, "critical",
                                             paramConfig, value);
-            convertConnectionToUnit(connName, callback);
+            unitResolver.resolve(connName, callback);
         }
     }
-    else if (std::isfinite(paramConfig.warningHigh) &&
-             (paramConfig.operatorType == "greater_than") &&
-             (value > paramConfig.warningHigh))
+    else if (paramConfig.predicate(value, paramConfig.warningHigh))
     {
         lg2::error(
-            "ASSERT: Dbus connection {SERVICE} is above the upper threshold warning high and value is {VALUE}",
-            "SERVICE", connName, "VALUE", value);
-        bool warningLogStatus = false;
-        if (logStatusMap.find(connKey) != logStatusMap.end())
-        {
-            warningLogStatus = logStatusMap[connKey].first;
-        }
-        else
-        {
-            // Insert the connection key and log status for fitrst time
-            logStatusMap[connKey] = std::make_pair(false, false);
-        }
+            "ASSERT: Dbus connection {SERVICE} is {OPERATOR} the warning threshold and value is {VALUE}",
+            "SERVICE", connName, "OPERATOR", paramConfig.predicate.describe(),
+            "VALUE", value);
+        bool warningLogStatus = state != nullptr && state->warningLogged;
 
         if (!warningLogStatus)
         {
             auto callback = std::bind_front(&DBusIpcSensor::logAndExecuteAction,
                                             this, connName, "warning",
                                             paramConfig, value);
-            convertConnectionToUnit(connName, callback);
+            unitResolver.resolve(connName, callback);
         }
     }
-    else if (std::isfinite(paramConfig.criticalHigh) &&
-             (paramConfig.operatorType == "less_than") &&
-             (value < paramConfig.criticalHigh))
-    {
-        // TODO: Add code to handle less than operator
-    }
-    else if (std::isfinite(paramConfig.warningHigh) &&
-             (paramConfig.operatorType == "less_than") &&
-             (value < paramConfig.warningHigh))
-    {
-        // TODO: Add code to handle less than operator
-    }
-    else if (paramConfig.operatorType == "equal")
+}
+auto DBusIpcSensor::getKeys(const IPCConfig& ipcConfig)
+    -> std::vector<std::string>
+{
+    std::vector<std::string> keys;
+    for (const auto& param : ipcConfig.paramConfig)
     {
-        // TODO: Add code to handle equal than operator
+        keys.push_back(param.key);
     }
+    return keys;
 }
+
 // Constructor implementation
-DBusIpcSensor::DBusIpcSensor(sdbusplus::bus::bus& bus, IPCConfig& ipcConfig,
+DBusIpcSensor::DBusIpcSensor(sdbusplus::asio::connection& conn,
+                             IPCConfig& ipcConfig,
                              boost::asio::io_context& io) :
-    IPCHealthSensor(bus, ipcConfig, io)
+    IPCHealthSensor(conn, ipcConfig, io), decoder(getKeys(ipcConfig)),
+    unitResolver(conn), unitMetrics(conn, ipcConfig)
 {}
 // Destructor implementation
 DBusIpcSensor::~DBusIpcSensor() {}
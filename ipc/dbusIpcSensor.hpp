@@ -1,5 +1,15 @@
 #pragma once
 #include "ipcHealthSensor.hpp"
+#include "queueGrowth.hpp"
+#include "statsDecoder.hpp"
+#include "unitMetrics.hpp"
+#include "unitResolver.hpp"
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace phosphor
 {
@@ -13,7 +23,7 @@ class DBusIpcSensor : public IPCHealthSensor
 {
   public:
     /* Forcing explicit construction */
-    DBusIpcSensor(sdbusplus::bus_t& bus, IPCConfig& ipcConfig,
+    DBusIpcSensor(sdbusplus::asio::connection& conn, IPCConfig& ipcConfig,
                   boost::asio::io_context& io);
     /* Destructor */
     virtual ~DBusIpcSensor();
@@ -24,11 +34,6 @@ class DBusIpcSensor : public IPCHealthSensor
     // Process statistic data implementation
     void processdata();
 
-    // Get unit name for connection name implementation
-    template <typename CallbackFn>
-    void convertConnectionToUnit(const std::string& connName,
-                                 CallbackFn&& callback);
-
     // Callback function to handle logging and start unit
     void logAndExecuteAction(const std::string connName,
                              const std::string thresholdType,
@@ -39,9 +44,48 @@ class DBusIpcSensor : public IPCHealthSensor
     virtual void init() override;
 
     // Overide checkSensorThreshold implementation
-    virtual void checkSensorThreshold(const double value,
-                                      const std::string& connectionName,
-                                      struct ParamConfig paramConfig) override;
+    virtual void
+        checkSensorThreshold(const double value,
+                             const std::string& connectionName,
+                             const struct ParamConfig& paramConfig) override;
+
+  private:
+    /** @brief Get the counter of every parameter, in paramConfig order */
+    static auto getKeys(const IPCConfig& ipcConfig)
+        -> std::vector<std::string>;
+    /** @brief Resolve the unit of the peers first seen in this read */
+    void resolveUnits();
+    /** @brief Publish the values of this read aggregated by unit */
+    void publishUnits();
+    /** @brief Find the state of a parameter of a known peer */
+    auto findState(const std::string& connName, const std::string& paramName)
+        -> ParamState*;
+
+    /** @brief Counters of a peer read by the previous GetStats */
+    struct Snapshot
+    {
+        std::chrono::steady_clock::time_point time;
+        std::unordered_map<std::string, unsigned int> counters;
+    };
+
+    /** @brief Get the growth per second of a peer queue since the previous
+     *         read, unset on the first read */
+    auto getGrowth(const std::string& connName, const std::string& key,
+                 unsigned int value,
+                 std::chrono::steady_clock::time_point now) const
+        -> std::optional<double>;
+
+    /** @brief Queue sizes of the rate parameters by peer, from the previous
+     *         read */
+    std::unordered_map<std::string, Snapshot> snapshots;
+    /** @brief Decoder of the configured counters from GetStats */
+    StatsDecoder decoder;
+    /** @brief Cached unit of the peers */
+    UnitResolver unitResolver;
+    /** @brief Unit of the current peers, unset until resolved */
+    std::unordered_map<std::string, std::optional<std::string>> peerUnits;
+    /** @brief D-Bus objects of the parameters by unit */
+    UnitMetrics unitMetrics;
 };
 } // namespace ipc
 } // namespace phosphor
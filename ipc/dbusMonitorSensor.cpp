@@ -0,0 +1,179 @@
+#include "dbusMonitorSensor.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+namespace phosphor
+{
+namespace ipc
+{
+
+PHOSPHOR_LOG2_USING;
+
+static constexpr auto defaultSystemBusAddress =
+    "unix:path=/run/dbus/system_bus_socket";
+
+DBusMonitorSensor::DBusMonitorSensor(sdbusplus::asio::connection& conn,
+                                     IPCConfig& ipcConfig,
+                                     boost::asio::io_context& io) :
+    DBusIpcSensor(conn, ipcConfig, io),
+    interval(std::max<uint16_t>(ipcConfig.freq, 1))
+{
+    // Unknown keys are rejected with the config, so unset is Messages
+    for (const auto& param : ipcConfig.paramConfig)
+    {
+        paramTypes.push_back(getMessageType(param.key));
+    }
+}
+
+void DBusMonitorSensor::init()
+{
+    thread = std::jthread([this](std::stop_token stop) { run(stop); });
+}
+
+void DBusMonitorSensor::readSensor()
+{
+    // Only the latest tick is used if several are ready
+    std::optional<MessageTick> latest;
+    MessageTick tick;
+    while (ticks.pop(tick))
+    {
+        latest = std::move(tick);
+    }
+    if (!latest || latest->duration.count() <= 0)
+    {
+        return;
+    }
+
+    asyncResp = getMessageRates(*latest, paramTypes);
+    quietSenders.fill(asyncResp, paramTypes.size());
+    auto seconds = latest->duration.count();
+
+    auto busiest = std::ranges::max_element(
+        latest->members, {}, [](const auto& member) { return member.second; });
+    if (busiest != latest->members.end())
+    {
+        lg2::debug("{IPC} busiest member is {MEMBER} at {RATE} messages/s",
+                   "IPC", ipcConfig.name, "MEMBER", busiest->first, "RATE",
+                   busiest->second / seconds);
+    }
+
+    if (asyncResp.size() > 0)
+    {
+        processdata();
+    }
+}
+
+auto DBusMonitorSensor::openMonitor() -> sd_bus*
+{
+    sd_bus* bus = nullptr;
+    auto rc = sd_bus_new(&bus);
+    if (rc < 0)
+    {
+        lg2::error("Failed to create the monitor connection: {ERROR}", "ERROR",
+                   rc);
+        return nullptr;
+    }
+
+    const char* address = std::getenv("DBUS_SYSTEM_BUS_ADDRESS");
+    if (address == nullptr)
+    {
+        address = defaultSystemBusAddress;
+    }
+    sd_bus_error error = SD_BUS_ERROR_NULL;
+    if ((rc = sd_bus_set_address(bus, address)) < 0 ||
+        (rc = sd_bus_set_bus_client(bus, 1)) < 0 ||
+        (rc = sd_bus_set_monitor(bus, 1)) < 0 || (rc = sd_bus_start(bus)) < 0)
+    {
+        lg2::error("Failed to connect the monitor to {ADDRESS}: {ERROR}",
+                   "ADDRESS", address, "ERROR", rc);
+        sd_bus_flush_close_unref(bus);
+        return nullptr;
+    }
+
+    // No match rules, so that every message is seen
+    rc = sd_bus_call_method(bus, "org.freedesktop.DBus",
+                            "/org/freedesktop/DBus",
+                            "org.freedesktop.DBus.Monitoring", "BecomeMonitor",
+                            &error, nullptr, "asu", 0, 0u);
+    if (rc < 0)
+    {
+        lg2::error("BecomeMonitor failed: {ERROR}", "ERROR",
+                   error.message != nullptr ? error.message : "unknown");
+        sd_bus_error_free(&error);
+        sd_bus_flush_close_unref(bus);
+        return nullptr;
+    }
+    return bus;
+}
+
+void DBusMonitorSensor::run(std::stop_token stop)
+{
+    using clock = std::chrono::steady_clock;
+    // The stop request is checked at least this often
+    static constexpr auto maxWait = std::chrono::seconds(1);
+
+    auto bus = openMonitor();
+    if (bus == nullptr)
+    {
+        return;
+    }
+    lg2::info("{IPC} monitors all messages on the bus", "IPC", ipcConfig.name);
+
+    MessageCounter counter;
+    auto start = clock::now();
+    while (!stop.stop_requested())
+    {
+        sd_bus_message* m = nullptr;
+        auto rc = sd_bus_process(bus, &m);
+        if (rc < 0)
+        {
+            lg2::error("{IPC} monitor connection failed: {ERROR}", "IPC",
+                       ipcConfig.name, "ERROR", rc);
+            break;
+        }
+        if (m != nullptr)
+        {
+            // Header fields only, the body is never read
+            uint8_t type = 0;
+            const char* sender = sd_bus_message_get_sender(m);
+            const char* member = sd_bus_message_get_member(m);
+            if (sd_bus_message_get_type(m, &type) >= 0 &&
+                type >= SD_BUS_MESSAGE_METHOD_CALL &&
+                type <= SD_BUS_MESSAGE_SIGNAL)
+            {
+                auto messageType = static_cast<MessageType>(
+                    type - SD_BUS_MESSAGE_METHOD_CALL);
+                counter.count(sender != nullptr ? sender : "",
+                              member != nullptr ? member : "", messageType);
+            }
+            sd_bus_message_unref(m);
+        }
+
+        auto now = clock::now();
+        if (now - start >= interval)
+        {
+            if (!ticks.push(counter.cut(now - start)))
+            {
+                lg2::warning("{IPC} ticks are not consumed, dropping one",
+                             "IPC", ipcConfig.name);
+            }
+            start = now;
+        }
+        if (rc > 0)
+        {
+            continue;
+        }
+
+        auto wait = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::min<clock::duration>(interval - (now - start), maxWait));
+        sd_bus_wait(bus, wait.count());
+    }
+    sd_bus_flush_close_unref(bus);
+}
+
+} // namespace ipc
+} // namespace phosphor
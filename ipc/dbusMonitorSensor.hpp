@@ -0,0 +1,75 @@
+#pragma once
+#include "../health_ring.hpp"
+#include "dbusIpcSensor.hpp"
+#include "messageCounter.hpp"
+
+#include <systemd/sd-bus.h>
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace phosphor
+{
+namespace ipc
+{
+
+/** @class DBusMonitorSensor
+ *  @brief D-Bus sensor thresholding the message rates of the peers
+ *
+ *  The byte counters of GetStats miss storms of small messages, so this
+ *  sensor becomes a bus monitor on a dedicated connection and counts every
+ *  message by sender, member and type from its header. The connection is
+ *  read on its own thread, which hands over the counts of every tick
+ *  through a lock-free ring. The parameter keys are Messages, MethodCalls,
+ *  MethodReturns, Errors and Signals, always valued in messages per second
+ *  and named <Key>/s, other keys are rejected with the config. A sender is
+ *  reported at 0 messages per second while quiet, and is only dropped once
+ *  quiet for maxQuietTicks ticks.
+ *  Windows, thresholds and actions are those of DBusIpcSensor.
+ *
+ *  The monitor connects to DBUS_SYSTEM_BUS_ADDRESS when set, so that it can
+ *  be run against a private dbus-daemon.
+ */
+class DBusMonitorSensor : public DBusIpcSensor
+{
+  public:
+    DBusMonitorSensor(sdbusplus::asio::connection& conn, IPCConfig& ipcConfig,
+                      boost::asio::io_context& io);
+    ~DBusMonitorSensor() override = default;
+
+    // Process the latest tick of the monitor thread
+    void readSensor() override;
+
+    // Start the monitor thread
+    void init() override;
+
+  private:
+    /** @brief Monitor thread */
+    void run(std::stop_token stop);
+    /** @brief Open a connection and make it a monitor, nullptr on failure */
+    static auto openMonitor() -> sd_bus*;
+
+    /** @brief Ticks in flight, ticks are dropped while it is full */
+    static constexpr size_t ringSize = 4;
+    /** @brief Ticks a known sender is reported at 0 messages per second */
+    static constexpr size_t maxQuietTicks = 10;
+
+    /** @brief Message type of every parameter, unset for all messages */
+    std::vector<std::optional<MessageType>> paramTypes;
+    /** @brief Length of a tick */
+    std::chrono::seconds interval;
+    /** @brief Senders to report while quiet, so that bursty ones are not
+     *         evicted between their bursts */
+    QuietSenders quietSenders{maxQuietTicks};
+    /** @brief Ticks handed over by the monitor thread */
+    health::ring::Ring<MessageTick, ringSize> ticks;
+    /** @brief Monitor thread, stopped first */
+    std::jthread thread;
+};
+
+} // namespace ipc
+} // namespace phosphor
@@ -2,11 +2,10 @@
 
 #include "ipcHealthSensor.hpp"
 
-#include "asio_connection.hpp"
 #include "dbusIpcSensor.hpp"
+#include "dbusMonitorSensor.hpp"
 
 #include <phosphor-logging/lg2.hpp>
-#include <sdbusplus/bus.hpp>
 #include <sdbusplus/message.hpp>
 #include <sdbusplus/server/manager.hpp>
 
@@ -19,23 +18,48 @@ namespace ipc
 PHOSPHOR_LOG2_USING;
 
 std::shared_ptr<IPCHealthSensor> IPCHealthSensor::getIPCHealthSensor(
-    sdbusplus::bus_t& bus, IPCConfig& ipcConfig, boost::asio::io_context& io)
+    sdbusplus::asio::connection& conn, IPCConfig& ipcConfig,
+    boost::asio::io_context& io)
 {
     if (ipcConfig.name == "dbus")
     {
-        return std::make_shared<phosphor::ipc::DBusIpcSensor>(bus, ipcConfig,
+        return std::make_shared<phosphor::ipc::DBusIpcSensor>(conn, ipcConfig,
                                                               io);
     }
+    if (ipcConfig.name == "dbus_monitor")
+    {
+        return std::make_shared<phosphor::ipc::DBusMonitorSensor>(
+            conn, ipcConfig, io);
+    }
     return nullptr;
 }
 
+auto IPCHealthSensor::getInitialStates(const IPCConfig& ipcConfig)
+    -> std::vector<ParamState>
+{
+    std::vector<ParamState> states;
+    for (const auto& paramConfig : ipcConfig.paramConfig)
+    {
+        // Counters are averaged as integers, rates as doubles
+        auto& state = states.emplace_back();
+        if (paramConfig.rate)
+        {
+            state.window.emplace<SlidingWindow<double>>(paramConfig.windowSize);
+        }
+        else
+        {
+            state.window.emplace<SlidingWindow<long int>>(
+                paramConfig.windowSize);
+        }
+    }
+    return states;
+}
+
 void IPCHealthSensor::initSensor()
 {
-    for (auto& paramConfig : ipcConfig.paramConfig)
+    for (size_t index = 0; index < ipcConfig.paramConfig.size(); index++)
     {
-        // list the properties to be monitored
-        statistics.push_back(
-            std::make_pair(paramConfig.key, paramConfig.valueType));
+        paramIndex.emplace(ipcConfig.paramConfig[index].name, index);
     }
 
     try
@@ -103,47 +127,18 @@ void IPCHealthSensor::createThresholdLogEntry(const std::string& threshold,
     }
 }
 
-bool IPCHealthSensor::checkCriticalLogRateLimitWindow()
+bool IPCHealthSensor::allowAction(const std::string& serviceName,
+                                  const struct ParamConfig& cfg,
+                                  health::ratelimit::Threshold::Type type)
 {
-    if (!std::chrono::duration_cast<std::chrono::seconds>(
-             lastCriticalLogLoggedTime.time_since_epoch())
-             .count())
-    {
-        // Update the last Critical log loggedTime
-        lastCriticalLogLoggedTime = std::chrono::high_resolution_clock::now();
-        return true;
-    }
-    std::chrono::duration<double> diff =
-        std::chrono::high_resolution_clock::now() - lastCriticalLogLoggedTime;
-    if (diff.count() > ipcConfig.logRateLimit)
-    {
-        // Update the last Critical log loggedTime
-        lastCriticalLogLoggedTime = std::chrono::high_resolution_clock::now();
-        return true;
-    }
-    return false;
-}
-
-bool IPCHealthSensor::checkWarningLogRateLimitWindow()
-{
-    if (!std::chrono::duration_cast<std::chrono::seconds>(
-             lastWarningLogLoggedTime.time_since_epoch())
-             .count())
-    {
-        // Update the last warning log loggedTime
-        lastWarningLogLoggedTime = std::chrono::high_resolution_clock::now();
-        return true;
-    }
-    std::chrono::duration<double> diff =
-        std::chrono::high_resolution_clock::now() - lastWarningLogLoggedTime;
-
-    if (diff.count() > ipcConfig.logRateLimit)
-    {
-        // Update the last warning log loggedTime
-        lastWarningLogLoggedTime = std::chrono::high_resolution_clock::now();
-        return true;
-    }
-    return false;
+    using Threshold = health::ratelimit::Threshold;
+    auto critical = type == Threshold::Type::Critical;
+    return actionLimiter.allow(
+        {.metric = ipcConfig.name + "/" + serviceName + "/" + cfg.name,
+         .type = type,
+         .bound = cfg.predicate.bound(),
+         .target = critical ? cfg.criticalTgt : cfg.warningTgt},
+        critical ? cfg.criticalRateLimit : cfg.warningRateLimit);
 }
 
 // This function is used to check the sensor threshold and log the required
@@ -151,56 +146,37 @@ bool IPCHealthSensor::checkWarningLogRateLimitWindow()
 // DBusIpcSensor
 void IPCHealthSensor::checkSensorThreshold(const double value,
                                            const std::string& serviceName,
-                                           struct ParamConfig cfg)
+                                           const struct ParamConfig& cfg)
 {
-    if (std::isfinite(cfg.criticalHigh) &&
-        (cfg.operatorType == "greater_than") && (value > cfg.criticalHigh))
+    if (cfg.predicate(value, cfg.criticalHigh))
     {
         lg2::error(
-            "ASSERT: IPC service {SERVICE} is above the upper threshold critical "
-            "high",
-            "SERVICE", ipcConfig.name);
-        if (checkCriticalLogRateLimitWindow())
+            "ASSERT: IPC service {SERVICE} is {OPERATOR} the critical threshold",
+            "SERVICE", ipcConfig.name, "OPERATOR", cfg.predicate.describe());
+        if (allowAction(serviceName, cfg,
+                        health::ratelimit::Threshold::Type::Critical))
         {
             lg2::info("Creating threshold log entry for critical");
 
-            createThresholdLogEntry("critical", serviceName, cfg.key, value,
+            createThresholdLogEntry("critical", serviceName, cfg.name, value,
                                     cfg.criticalHigh);
             startUnit(cfg.criticalTgt, serviceName, "CrossedCriticalThreshold");
         }
     }
-    else if (std::isfinite(cfg.criticalHigh) &&
-             (cfg.operatorType == "less_than") && (value < cfg.criticalHigh))
-    {
-        // TODO: Add code to handle less than operator
-    }
-    else if (cfg.operatorType == "equal")
-    {
-        // TODO: Add code to handle equal than operator
-    }
 
-    if (std::isfinite(cfg.warningHigh) &&
-        (cfg.operatorType == "greater_than") && (value > cfg.warningHigh))
+    if (cfg.predicate(value, cfg.warningHigh))
     {
         lg2::error(
-            "ASSERT: IPC service {SERVICE} is above the upper threshold warning high",
-            "SERVICE", ipcConfig.name);
-        if (checkWarningLogRateLimitWindow())
+            "ASSERT: IPC service {SERVICE} is {OPERATOR} the warning threshold",
+            "SERVICE", ipcConfig.name, "OPERATOR", cfg.predicate.describe());
+        if (allowAction(serviceName, cfg,
+                        health::ratelimit::Threshold::Type::Warning))
         {
             lg2::info("Creating threshold log entry for warning");
-            createThresholdLogEntry("warning", serviceName, cfg.key, value,
+            createThresholdLogEntry("warning", serviceName, cfg.name, value,
                                     cfg.warningHigh);
         }
     }
-    else if (std::isfinite(cfg.warningHigh) &&
-             (cfg.operatorType == "less_than") && (value < cfg.warningHigh))
-    {
-        // TODO: Add code to handle less than operator
-    }
-    else if (cfg.operatorType == "equal")
-    {
-        // TODO: Add code to handle equal than operator
-    }
 }
 
 // Create log entry implementation
@@ -208,17 +184,11 @@ void IPCHealthSensor::createRFLogEntry(const std::string& messageId,
                                        const std::string& messageArgs,
                                        const std::string& level)
 {
-    auto& connObject = AsioConnection::getAsioConnection();
-    if (connObject == nullptr)
-    {
-        lg2::error("Connection object is null");
-        return;
-    }
     std::map<std::string, std::string> addData;
     addData["REDFISH_MESSAGE_ID"] = messageId;
     addData["REDFISH_MESSAGE_ARGS"] = messageArgs;
     // Make call to DBus Debug Service to create log entry
-    connObject->async_method_call(
+    conn.async_method_call(
         [](const boost::system::error_code ec) {
         if (ec)
         {
@@ -236,12 +206,6 @@ void IPCHealthSensor::startUnit(const std::string& sysdUnit,
                                 const std::string& serviceName,
                                 const std::string& additionalData)
 {
-    auto& connObject = AsioConnection::getAsioConnection();
-    if (connObject == nullptr)
-    {
-        lg2::error("Connection object is null");
-        return;
-    }
     if (sysdUnit.empty())
     {
         return;
@@ -257,7 +221,7 @@ void IPCHealthSensor::startUnit(const std::string& sysdUnit,
     auto p = service.find('@');
     if (p != std::string::npos)
         service.insert(p + 1, args);
-    connObject->async_method_call(
+    conn.async_method_call(
         [](const boost::system::error_code ec) {
         if (ec)
         {
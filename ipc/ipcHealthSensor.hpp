@@ -1,19 +1,21 @@
 #pragma once
 #include "ipcConfig.hpp"
+#include "peerTable.hpp"
+#include "slidingWindow.hpp"
 
 #include <boost/asio/steady_timer.hpp>
-#include <boost/container/flat_map.hpp>
-#include <sdbusplus/bus.hpp>
+#include <sdbusplus/asio/connection.hpp>
 #include <sdbusplus/message.hpp>
 #include <sdeventplus/clock.hpp>
 #include <sdeventplus/event.hpp>
 #include <sdeventplus/utility/timer.hpp>
 
 #include <chrono>
-#include <deque>
+#include <cstddef>
 #include <limits>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <variant>
 namespace phosphor
 {
@@ -35,24 +37,26 @@ class IPCHealthSensor
 
     /** @brief Constructs IPCHealthSensor
      *
-     * @param[in] bus     - Handle to system dbus
-     * @param[in] objPath - The Dbus path of health sensor
+     * @param[in] conn      - Connection to system dbus, on io
+     * @param[in] ipcConfig - Sensor config from config file
+     * @param[in] io        - The io_context running the connection
      */
-    IPCHealthSensor(sdbusplus::bus_t& bus, IPCConfig& ipcConfig,
+    IPCHealthSensor(sdbusplus::asio::connection& conn, IPCConfig& ipcConfig,
                     boost::asio::io_context& io) :
-        bus(bus),
-        ipcConfig(ipcConfig), timer(io)
+        conn(conn),
+        ipcConfig(ipcConfig), timer(io),
+        peers(getInitialStates(ipcConfig), maxPeers)
     {}
     /** @brief Initialize sensor, set default value and association */
     void initSensor();
     static std::shared_ptr<IPCHealthSensor>
-        getIPCHealthSensor(sdbusplus::bus_t& bus, IPCConfig& ipcConfig,
-                           boost::asio::io_context& io);
+        getIPCHealthSensor(sdbusplus::asio::connection& conn,
+                           IPCConfig& ipcConfig, boost::asio::io_context& io);
 
     /** @brief Check Sensor threshold and create log  and take action*/
     virtual void checkSensorThreshold(const double value,
                                       const std::string& serviceName,
-                                      struct ParamConfig cfg);
+                                      const struct ParamConfig& cfg);
 
     /** @brief create Sensor Treshold Redfish log  */
     void createThresholdLogEntry(const std::string& threshold,
@@ -66,46 +70,63 @@ class IPCHealthSensor
     void readSensordata();
 
   protected:
-    // map to store the sensor value and its queue
-    boost::container::flat_map<std::pair<std::string, std::string>,
-                               std::deque<std::variant<long int, double>>>
-        valQueueMap;
-
-    // map to store the IPC sensor and its string value
-    boost::container::flat_map<std::pair<std::string, std::string>, std::string>
-        valStringMap;
-
-    // map to store the IPC sensor log status
-    boost::container::flat_map<std::pair<std::string, std::string>,
-                               std::pair<bool, bool>>
-        logStatusMap;
-
-    /** the statistcis to get from sensor */
-    std::vector<std::pair<std::string, std::string>> statistics;
-    /** response of IPC call stored as class member to avoid copy elison */
-    std::map<std::string,
-             std::vector<std::pair<
-                 std::string, std::variant<long int, double, std::string>>>>
-        asyncResp;
-    /** @brief sdbusplus bus client connection. */
-    sdbusplus::bus_t& bus;
+    /** @brief Parameter index by parameter name, resolved in initSensor() */
+    std::unordered_map<std::string, size_t> paramIndex;
+    /** response of IPC call stored as class member to avoid copy elison,
+     *  parameter index and value by peer */
+    std::map<std::string, std::vector<std::pair<size_t, double>>> asyncResp;
+    /** @brief D-Bus connection for the calls and the published objects */
+    sdbusplus::asio::connection& conn;
     /** @brief Sensor config from config file */
     IPCConfig& ipcConfig;
     /** @brief Timer to read sensor at regular interval */
     boost::asio::steady_timer timer;
 
-    std::chrono::time_point<std::chrono::high_resolution_clock>
-        lastCriticalLogLoggedTime;
-    std::chrono::time_point<std::chrono::high_resolution_clock>
-        lastWarningLogLoggedTime;
+    /** @brief Rate limiter of the threshold actions */
+    health::ratelimit::RateLimiter actionLimiter;
+    /** @brief State of a monitored parameter of a peer */
+    struct ParamState
+    {
+        /** @brief Averaging window, of counters or of rates, empty while the
+         *         value is below warning */
+        std::variant<SlidingWindow<long int>, SlidingWindow<double>> window;
+        /** @brief Set once the warning action was taken */
+        bool warningLogged = false;
+        /** @brief Set once the critical action was taken */
+        bool criticalLogged = false;
+        /** @brief Value of the current read, NaN if it has none */
+        double value = std::numeric_limits<double>::quiet_NaN();
+        /** @brief Set while the window average crosses the warning */
+        bool warningAsserted = false;
+        /** @brief Set while the window average crosses the critical */
+        bool criticalAsserted = false;
+
+        /** @brief Check if the window has no samples */
+        auto windowEmpty() const -> bool
+        {
+            return std::visit([](const auto& w) { return w.empty(); },
+                              window);
+        }
+    };
+
+    /** @brief Get the initial state of every parameter, with its window */
+    static auto getInitialStates(const IPCConfig& ipcConfig)
+        -> std::vector<ParamState>;
+
+    /** @brief Maximum number of peers tracked */
+    static constexpr size_t maxPeers = 4096;
+    /** @brief Parameter state by peer */
+    PeerTable<ParamState> peers;
+
     /** @brief Read sensor at regular intrval */
     virtual void readSensor() = 0;
     /** @brief Initialize IPC sensor */
     virtual void init() = 0;
-    /** @brief check critical log rate limit */
-    bool checkCriticalLogRateLimitWindow();
-    /** @brief check warning log rate limit */
-    bool checkWarningLogRateLimitWindow();
+    /** @brief Check if the threshold action for a service property may be
+     *         taken now */
+    bool allowAction(const std::string& serviceName,
+                     const struct ParamConfig& cfg,
+                     health::ratelimit::Threshold::Type type);
     /** @brief Start configured threshold systemd unit */
     void startUnit(const std::string& sysdUnit, const std::string& serviceName,
                    const std::string& additionalData);
@@ -1,6 +1,7 @@
 #include "config.h"
 
 #include "ipcMonitor.hpp"
+#include "unitMetrics.hpp"
 
 #include <sdbusplus/asio/connection.hpp>
 #include <sdbusplus/asio/object_server.hpp>
@@ -19,17 +20,18 @@ int main()
     // DBus connection
     auto conn = std::make_shared<sdbusplus::asio::connection>(io);
 
+    // Object manager of the IPC metrics, aggregated by unit
+    sdbusplus::server::manager_t manager{*conn, phosphor::ipc::ipcMetricPath};
+    conn->request_name("xyz.openbmc_project.HealthMon.IPC");
+
     // Get a default event loop
     auto event = sdeventplus::Event::get_default();
     // Create an IPC monitor object
     std::shared_ptr<phosphor::ipc::IPCMonitor> ipcMon =
         std::make_shared<phosphor::ipc::IPCMonitor>(*conn, io);
 
-    // Sleep until system boot
-    ipcMon->sleepuntilSystemBoot();
-
-    // create sensors
-    ipcMon->createSensors();
+    // Create the sensors once the system booted, D-Bus is served meanwhile
+    ipcMon->startAfterSystemBoot();
 
     // Run the io_context
     io.run();
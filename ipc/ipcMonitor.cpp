@@ -2,6 +2,10 @@
 
 #include "ipcMonitor.hpp"
 
+#include "../health_uptime.hpp"
+#include "messageCounter.hpp"
+
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <memory>
@@ -14,13 +18,29 @@ namespace ipc
 {
 PHOSPHOR_LOG2_USING;
 
+/* Threshold action rate limit, Log_rate_limit unless overridden */
+static auto getRateLimit(const Json& thresholdJson, uint16_t logRateLimit)
+    -> health::ratelimit::Limit
+{
+    health::ratelimit::Limit limit{.burst = 1,
+                                   .period = std::chrono::seconds(logRateLimit)};
+    if (thresholdJson.contains("Rate_limit"))
+    {
+        const auto& rateLimit = thresholdJson["Rate_limit"];
+        limit.burst = rateLimit.value("Burst", limit.burst);
+        limit.period = std::chrono::seconds(
+            rateLimit.value("Period", limit.period.count()));
+    }
+    return limit;
+}
+
 /* Create dbus utilization sensor object */
 void IPCMonitor::createSensors()
 {
     for (auto& cfg : configs)
     {
         const std::shared_ptr<IPCHealthSensor>& ipcSensor =
-            IPCHealthSensor::getIPCHealthSensor(bus, cfg, ioc);
+            IPCHealthSensor::getIPCHealthSensor(conn, cfg, ioc);
         if (ipcSensor != nullptr)
         {
             ipcSensors.emplace(cfg.name, ipcSensor);
@@ -82,7 +102,53 @@ const std::vector<IPCConfig> IPCMonitor::getIPCConfig()
                     ParamConfig paramConfig;
                     paramConfig.key = paramJson["Key"];
                     paramConfig.valueType = paramJson["Value_type"];
+                    // The bus only reports unsigned integer counters
+                    if (paramConfig.valueType != "int")
+                    {
+                        lg2::error(
+                            "Invalid value type {TYPE} for {KEY}, skipping it",
+                            "TYPE", paramConfig.valueType, "KEY",
+                            paramConfig.key);
+                        continue;
+                    }
+                    if (ipcConfig.name == "dbus_monitor")
+                    {
+                        // Message counts are only meaningful per second
+                        if (!isMessageKey(paramConfig.key))
+                        {
+                            lg2::error(
+                                "Invalid message counter {KEY}, skipping it",
+                                "KEY", paramConfig.key);
+                            continue;
+                        }
+                        paramConfig.rate = true;
+                        paramConfig.name = paramConfig.key + "/s";
+                    }
+                    else
+                    {
+                        // The PeerAccounting counters are the bytes and fds
+                        // queued for a peer. Rates threshold their signed
+                        // growth per second between two reads instead of
+                        // their value.
+                        paramConfig.rate = paramJson.value("Rate", false);
+                        paramConfig.name = paramConfig.rate
+                                               ? paramConfig.key + "Growth/s"
+                                               : paramConfig.key;
+                    }
+                    paramConfig.windowSize = paramJson.value(
+                        "Window_size", ipcConfig.windowSize);
                     paramConfig.operatorType = paramJson["Operator"];
+                    auto predicate =
+                        Predicate::compile(paramConfig.operatorType);
+                    if (!predicate)
+                    {
+                        lg2::error(
+                            "Invalid operator {OPERATOR} for {KEY}, skipping it",
+                            "OPERATOR", paramConfig.operatorType, "KEY",
+                            paramConfig.key);
+                        continue;
+                    }
+                    paramConfig.predicate = *predicate;
                     paramConfig.criticalHigh =
                         paramJson["Threshold"]["Critical"]["Value"];
                     paramConfig.criticalTgt =
@@ -91,6 +157,12 @@ const std::vector<IPCConfig> IPCMonitor::getIPCConfig()
                         paramJson["Threshold"]["Warning"]["Value"];
                     paramConfig.warningTgt =
                         paramJson["Threshold"]["Warning"]["Target"];
+                    paramConfig.criticalRateLimit = getRateLimit(
+                        paramJson["Threshold"]["Critical"],
+                        ipcConfig.logRateLimit);
+                    paramConfig.warningRateLimit = getRateLimit(
+                        paramJson["Threshold"]["Warning"],
+                        ipcConfig.logRateLimit);
 
                     ipcConfig.paramConfig.push_back(paramConfig);
                 }
@@ -108,6 +180,8 @@ const std::vector<IPCConfig> IPCMonitor::getIPCConfig()
             for (const auto& param : config.paramConfig)
             {
                 lg2::info("Key: {IPC} ", "IPC", param.key);
+                lg2::info("Rate: {IPC} ", "IPC", param.rate);
+                lg2::info("Window Size: {IPC} ", "IPC", param.windowSize);
                 lg2::info("Value Type: {IPC} ", "IPC", param.valueType);
                 lg2::info("Operator: {IPC}", "IPC", param.operatorType);
                 lg2::info("Critical Value:{IPC}", "IPC", param.criticalHigh);
@@ -129,11 +203,30 @@ const std::vector<IPCConfig> IPCMonitor::getIPCConfig()
     return ipcConfigs;
 }
 
-void IPCMonitor::sleepuntilSystemBoot()
+void IPCMonitor::startAfterSystemBoot()
 {
-    lg2::info("ipc monitor is waiting for system boot");
-    // wait for the system to boot up
-    sleep(bootDelay);
+    // The delay counts from boot, not from the start of the process, so that
+    // a restart on a BMC which is up for long monitors right away
+    auto remaining = std::chrono::seconds(bootDelay) -
+                     health::utils::getUptime();
+    if (remaining <= std::chrono::seconds(0))
+    {
+        createSensors();
+        return;
+    }
+
+    lg2::info("ipc monitor is waiting {SECONDS}s for system boot", "SECONDS",
+              remaining.count());
+    bootTimer.expires_after(remaining);
+    bootTimer.async_wait([this](const boost::system::error_code& ec) {
+        if (ec)
+        {
+            lg2::error("Boot delay timer failed: {ERROR}", "ERROR",
+                       ec.message());
+            return;
+        }
+        createSensors();
+    });
 }
 
 } // namespace ipc
@@ -1,9 +1,10 @@
 #include "ipcConfig.hpp"
 #include "ipcHealthSensor.hpp"
 
+#include <boost/asio/steady_timer.hpp>
 #include <nlohmann/json.hpp>
 #include <phosphor-logging/lg2.hpp>
-#include <sdbusplus/bus.hpp>
+#include <sdbusplus/asio/connection.hpp>
 #include <sdbusplus/message.hpp>
 #include <sdbusplus/server/manager.hpp>
 #include <sdeventplus/clock.hpp>
@@ -31,17 +32,19 @@ class IPCMonitor
     void createSensors();
     /** @brief Constructs IPCMonitor
      *
-     * @param[in] bus     - Handle to system dbus
+     * @param[in] conn - Connection to system dbus, shared by the sensors
+     * @param[in] io   - The io_context running the connection
      */
-    IPCMonitor(sdbusplus::bus_t& bus, boost::asio::io_context& io) :
-        bus(bus), ioc(io)
+    IPCMonitor(sdbusplus::asio::connection& conn, boost::asio::io_context& io) :
+        conn(conn), ioc(io), bootTimer(io)
     {
         // Read JSON file
         configs = getIPCConfig();
     }
 
-    /** Sleep until boot delay time */
-    void sleepuntilSystemBoot();
+    /** @brief Create the sensors once the boot delay passed since boot,
+     *         right away if it already did */
+    void startAfterSystemBoot();
 
     /** @brief Map of the object IPCHealthSensor */
     std::unordered_map<std::string, std::shared_ptr<IPCHealthSensor>>
@@ -54,12 +57,14 @@ class IPCMonitor
 
   private:
     /** @brief Logging Rate Limit */
-    sdbusplus::bus_t& bus;
+    sdbusplus::asio::connection& conn;
     boost::asio::io_context& ioc;
     unsigned int logRateLimit;
     std::vector<IPCConfig> configs;
     const std::vector<IPCConfig> getIPCConfig();
-    unsigned int bootDelay;
+    unsigned int bootDelay = 0;
+    /** @brief Timer of the remaining boot delay */
+    boost::asio::steady_timer bootTimer;
 };
 
 } // namespace ipc
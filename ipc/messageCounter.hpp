@@ -0,0 +1,273 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace phosphor
+{
+namespace ipc
+{
+
+/** @brief D-Bus message types, in sd-bus order starting at method calls */
+enum class MessageType : uint8_t
+{
+    methodCall,
+    methodReturn,
+    methodError,
+    signal
+};
+
+/** @brief Number of message types */
+static constexpr size_t messageTypes = 4;
+
+/** @brief Get the message type of a key, e.g. Signals, unset for Messages
+ *         which counts all types */
+inline auto getMessageType(std::string_view key) -> std::optional<MessageType>
+{
+    if (key == "MethodCalls")
+    {
+        return MessageType::methodCall;
+    }
+    if (key == "MethodReturns")
+    {
+        return MessageType::methodReturn;
+    }
+    if (key == "Errors")
+    {
+        return MessageType::methodError;
+    }
+    if (key == "Signals")
+    {
+        return MessageType::signal;
+    }
+    return std::nullopt;
+}
+
+/** @brief Check if a key is a message counter, a type or Messages */
+inline auto isMessageKey(std::string_view key) -> bool
+{
+    return key == "Messages" || getMessageType(key).has_value();
+}
+
+/** @brief Hash of string keys which may be looked up by string_view */
+struct StringHash
+{
+    using is_transparent = void;
+
+    auto operator()(std::string_view key) const -> size_t
+    {
+        return std::hash<std::string_view>{}(key);
+    }
+};
+
+/** @brief Message counts of one tick */
+struct MessageTick
+{
+    /** @brief Counts by type */
+    using counts_t = std::array<uint64_t, messageTypes>;
+
+    /** @brief Length of the tick */
+    std::chrono::duration<double> duration{0};
+    /** @brief Counts by sender */
+    std::unordered_map<std::string, counts_t, StringHash, std::equal_to<>>
+        senders;
+    /** @brief Method call and signal counts by member */
+    std::unordered_map<std::string, uint64_t, StringHash, std::equal_to<>>
+        members;
+};
+
+/** @brief Sender of the messages of the bus driver */
+static constexpr std::string_view busDriver = "org.freedesktop.DBus";
+
+/** @brief Parameter index and messages per second by sender */
+using rates_t = std::map<std::string, std::vector<std::pair<size_t, double>>>;
+
+/** @brief Get the messages per second of every sender in a tick
+ *
+ *  @param[in] tick - Counts of the tick
+ *  @param[in] types - Message type of every parameter, unset for all types
+ *  @return Parameter index and rate by sender, in the order of the types.
+ *          The bus driver is not a peer, its messages are left out, as are
+ *          messages without a sender.
+ */
+inline auto getMessageRates(const MessageTick& tick,
+                            std::span<const std::optional<MessageType>> types)
+    -> rates_t
+{
+    rates_t rates;
+    auto seconds = tick.duration.count();
+    if (seconds <= 0)
+    {
+        return rates;
+    }
+    for (const auto& [sender, counts] : tick.senders)
+    {
+        if (sender.empty() || sender == busDriver)
+        {
+            continue;
+        }
+        auto& senderRates = rates[sender];
+        for (size_t index = 0; index < types.size(); index++)
+        {
+            auto count = types[index]
+                             ? counts[static_cast<size_t>(*types[index])]
+                             : std::accumulate(counts.begin(), counts.end(),
+                                               uint64_t{0});
+            senderRates.emplace_back(index, count / seconds);
+        }
+    }
+    return rates;
+}
+
+/** @class QuietSenders
+ *  @brief Keeps reporting the senders which were quiet for a few ticks
+ *
+ *  A sender only shows up in the ticks it sent something in, so a bursty
+ *  one would be taken for gone between its bursts, losing its windows and
+ *  the objects of its unit. Known senders are reported at 0 messages per
+ *  second instead, until they stay quiet for more than the given number of
+ *  ticks.
+ */
+class QuietSenders
+{
+  public:
+    explicit QuietSenders(size_t maxQuietTicks) : maxQuietTicks(maxQuietTicks)
+    {}
+
+    /** @brief Add the quiet senders to the rates of a tick with the given
+     *         number of parameters, and forget the ones quiet for too long */
+    void fill(rates_t& rates, size_t params)
+    {
+        for (auto it = quietTicks.begin(); it != quietTicks.end();)
+        {
+            if (rates.contains(it->first))
+            {
+                it->second = 0;
+            }
+            else if (++it->second > maxQuietTicks)
+            {
+                it = quietTicks.erase(it);
+                continue;
+            }
+            else
+            {
+                auto& senderRates = rates[it->first];
+                for (size_t index = 0; index < params; index++)
+                {
+                    senderRates.emplace_back(index, 0.0);
+                }
+            }
+            ++it;
+        }
+        for (const auto& [sender, senderRates] : rates)
+        {
+            quietTicks.try_emplace(sender, 0);
+        }
+    }
+
+    /** @brief Number of known senders */
+    auto size() const -> size_t
+    {
+        return quietTicks.size();
+    }
+
+  private:
+    /** @brief Ticks a sender may stay quiet before it is forgotten */
+    size_t maxQuietTicks;
+    /** @brief Consecutive quiet ticks by known sender */
+    std::unordered_map<std::string, size_t, StringHash, std::equal_to<>>
+        quietTicks;
+};
+
+/** @class MessageCounter
+ *  @brief Counts the messages seen on the bus by sender, member and type
+ *
+ *  Only header fields are used. The counter is owned by the thread reading
+ *  the bus, so it needs no locking, and cut() hands over a copy of the
+ *  counts of a tick. The senders and members which were active in the last
+ *  tick are kept and zeroed in place, so that counting their messages does
+ *  not allocate, while the idle ones are dropped.
+ */
+class MessageCounter
+{
+  public:
+    /** @brief Count a message, the sender may be empty if unknown */
+    void count(std::string_view sender, std::string_view member,
+               MessageType type)
+    {
+        auto index = static_cast<size_t>(type);
+        if (index >= messageTypes)
+        {
+            return;
+        }
+        auto it = tick.senders.find(sender);
+        if (it == tick.senders.end())
+        {
+            it = tick.senders
+                     .emplace(std::string(sender), MessageTick::counts_t{})
+                     .first;
+        }
+        it->second[index]++;
+
+        if (member.empty())
+        {
+            return;
+        }
+        auto m = tick.members.find(member);
+        if (m == tick.members.end())
+        {
+            m = tick.members.emplace(std::string(member), 0).first;
+        }
+        m->second++;
+    }
+
+    /** @brief Take the counts of the tick which lasted the given time, and
+     *         start a new one */
+    auto cut(std::chrono::duration<double> duration) -> MessageTick
+    {
+        MessageTick counts;
+        counts.duration = duration;
+        for (auto it = tick.senders.begin(); it != tick.senders.end();)
+        {
+            if (it->second == MessageTick::counts_t{})
+            {
+                it = tick.senders.erase(it);
+                continue;
+            }
+            counts.senders.emplace(it->first, it->second);
+            it->second = {};
+            ++it;
+        }
+        for (auto it = tick.members.begin(); it != tick.members.end();)
+        {
+            if (it->second == 0)
+            {
+                it = tick.members.erase(it);
+                continue;
+            }
+            counts.members.emplace(it->first, it->second);
+            it->second = 0;
+            ++it;
+        }
+        return counts;
+    }
+
+  private:
+    /** @brief Counts of the current tick */
+    MessageTick tick;
+};
+
+} // namespace ipc
+} // namespace phosphor
@@ -1,4 +1,8 @@
 #pragma once
+#include "../health_rate_limiter.hpp"
+#include "predicate.hpp"
+
+#include <cstdint>
 #include <limits>
 #include <string>
 namespace phosphor
@@ -11,14 +15,20 @@ namespace ipc
 struct ParamConfig
 {
     std::string key;                              // service property name
-    std::string valueType;                        // value type
+    std::string name;                             // key, keyGrowth/s for rates
+    std::string valueType;                        // value type, int
+    bool rate = false;                            // signed growth per second
+    uint16_t windowSize = 1;                      // samples to average
     std::string operatorType;                     // operator type
+    Predicate predicate;                          // compiled operator type
     double criticalHigh =
         std::numeric_limits<double>::quiet_NaN(); // critical value
     double warningHigh =
         std::numeric_limits<double>::quiet_NaN(); // warning value
     std::string criticalTgt;                      // critical target
     std::string warningTgt;                       // warning target
+    health::ratelimit::Limit criticalRateLimit;   // critical action limit
+    health::ratelimit::Limit warningRateLimit;    // warning action limit
 };
 } // namespace ipc
 } // namespace phosphor
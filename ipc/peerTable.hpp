@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace phosphor
+{
+namespace ipc
+{
+
+/** @class PeerTable
+ *  @brief State of the monitored parameters of every D-Bus peer
+ *
+ *  Peer names are interned to dense IDs when first seen, the state of a
+ *  parameter is then addressed by ID and parameter index. Every read of the
+ *  bus starts a new generation, and sweep() evicts the peers which were not
+ *  seen in it, so that only connected peers are kept. The number of peers is
+ *  capped, so that memory use stays bounded however many peers come and go.
+ */
+template <typename State>
+class PeerTable
+{
+  public:
+    using id_t = uint32_t;
+
+    PeerTable(size_t params, size_t capacity) :
+        PeerTable(std::vector<State>(params), capacity)
+    {}
+    /** @brief Create a table whose peers start with the given states */
+    PeerTable(std::vector<State> initial, size_t capacity) :
+        initial(std::move(initial)), capacity(capacity)
+    {}
+
+    /** @brief Start a new read of the bus */
+    void beginGeneration()
+    {
+        generation++;
+    }
+
+    /** @brief Get the ID of a peer, adding it if needed, and mark it seen in
+     *         the current generation
+     *
+     *  @return The peer ID, unset if the table is full
+     */
+    auto intern(const std::string& name) -> std::optional<id_t>
+    {
+        if (auto id = ids.find(name); id != ids.end())
+        {
+            slots[id->second].seen = generation;
+            return id->second;
+        }
+        if (ids.size() >= capacity)
+        {
+            return std::nullopt;
+        }
+
+        id_t id = 0;
+        if (!freeIds.empty())
+        {
+            id = freeIds.back();
+            freeIds.pop_back();
+        }
+        else
+        {
+            id = static_cast<id_t>(slots.size());
+            slots.emplace_back();
+        }
+        auto& slot = slots[id];
+        slot.name = name;
+        slot.seen = generation;
+        slot.states = initial;
+        ids.emplace(name, id);
+        return id;
+    }
+
+    /** @brief Get the ID of a known peer without marking it seen */
+    auto find(const std::string& name) const -> std::optional<id_t>
+    {
+        if (auto id = ids.find(name); id != ids.end())
+        {
+            return id->second;
+        }
+        return std::nullopt;
+    }
+
+    /** @brief Get the state of a parameter of a peer */
+    auto state(id_t id, size_t param) -> State&
+    {
+        return slots[id].states[param];
+    }
+
+    /** @brief Get the name of a peer */
+    auto name(id_t id) const -> const std::string&
+    {
+        return slots[id].name;
+    }
+
+    /** @brief Evict the peers not seen in the current generation
+     *
+     *  @return The number of evicted peers
+     */
+    auto sweep() -> size_t
+    {
+        size_t evicted = 0;
+        for (auto it = ids.begin(); it != ids.end();)
+        {
+            auto& slot = slots[it->second];
+            if (slot.seen == generation)
+            {
+                ++it;
+                continue;
+            }
+            slot.name.clear();
+            slot.states.clear();
+            slot.states.shrink_to_fit();
+            freeIds.push_back(it->second);
+            it = ids.erase(it);
+            evicted++;
+        }
+        return evicted;
+    }
+
+    /** @brief Number of peers */
+    auto size() const -> size_t
+    {
+        return ids.size();
+    }
+
+  private:
+    /** @brief A peer, or a free slot if the name is empty */
+    struct Slot
+    {
+        std::string name;
+        /** @brief Last generation the peer was seen in */
+        uint64_t seen = 0;
+        /** @brief State by parameter index */
+        std::vector<State> states;
+    };
+
+    /** @brief Initial state of every parameter of a peer */
+    std::vector<State> initial;
+    /** @brief Maximum number of peers */
+    size_t capacity;
+    /** @brief Current generation */
+    uint64_t generation = 0;
+    /** @brief Peer IDs by name */
+    std::unordered_map<std::string, id_t> ids;
+    /** @brief Peers by ID */
+    std::vector<Slot> slots;
+    /** @brief IDs of the free slots */
+    std::vector<id_t> freeIds;
+};
+
+} // namespace ipc
+} // namespace phosphor
@@ -0,0 +1,94 @@
+#pragma once
+#include "../health_rate_limiter.hpp"
+
+#include <cmath>
+#include <optional>
+#include <string_view>
+namespace phosphor
+{
+namespace ipc
+{
+/** @brief Comparison of a parameter value against its thresholds */
+enum class Operator
+{
+    greaterThan,
+    lessThan,
+    equal
+};
+
+/** @struct Predicate
+ *  @brief Threshold comparison compiled from the configured operator
+ *
+ *  The operator string is parsed once when the configuration is loaded, so
+ *  that the evaluation of every sample is a single indirect call.
+ */
+struct Predicate
+{
+    Operator op = Operator::greaterThan;
+    bool (*test)(double value, double threshold) = greaterThan;
+
+    /** @brief Compile an operator, unset if it is unknown */
+    static auto compile(std::string_view operatorType)
+        -> std::optional<Predicate>
+    {
+        if (operatorType == "greater_than")
+        {
+            return Predicate{Operator::greaterThan, greaterThan};
+        }
+        if (operatorType == "less_than")
+        {
+            return Predicate{Operator::lessThan, lessThan};
+        }
+        if (operatorType == "equal")
+        {
+            return Predicate{Operator::equal, equal};
+        }
+        return std::nullopt;
+    }
+
+    /** @brief Check if a value crosses a threshold, never for an unset
+     *         threshold */
+    auto operator()(double value, double threshold) const -> bool
+    {
+        return std::isfinite(threshold) && test(value, threshold);
+    }
+
+    /** @brief Bound of the thresholds, for the action rate limits */
+    auto bound() const -> health::ratelimit::Threshold::Bound
+    {
+        return op == Operator::lessThan
+                   ? health::ratelimit::Threshold::Bound::Lower
+                   : health::ratelimit::Threshold::Bound::Upper;
+    }
+
+    /** @brief Describe a crossing in logs */
+    auto describe() const -> std::string_view
+    {
+        switch (op)
+        {
+            case Operator::lessThan:
+                return "below";
+            case Operator::equal:
+                return "equal to";
+            case Operator::greaterThan:
+            default:
+                return "above";
+        }
+    }
+
+  private:
+    static auto greaterThan(double value, double threshold) -> bool
+    {
+        return value > threshold;
+    }
+    static auto lessThan(double value, double threshold) -> bool
+    {
+        return value < threshold;
+    }
+    static auto equal(double value, double threshold) -> bool
+    {
+        return value == threshold;
+    }
+};
+} // namespace ipc
+} // namespace phosphor
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+
+namespace phosphor
+{
+namespace ipc
+{
+
+/** @brief Get the growth per second of a peer queue between two reads
+ *
+ *  The PeerAccounting counters of GetStats are the bytes and fds currently
+ *  charged to a peer, which go down as its queues drain. The growth is thus
+ *  signed: positive while the queue builds up, negative while it drains.
+ *  Unset if no time elapsed between the reads.
+ */
+inline auto getQueueGrowth(unsigned int previous, unsigned int value,
+                           std::chrono::duration<double> elapsed)
+    -> std::optional<double>
+{
+    if (elapsed.count() <= 0)
+    {
+        return std::nullopt;
+    }
+    return (static_cast<double>(value) - static_cast<double>(previous)) /
+           elapsed.count();
+}
+
+} // namespace ipc
+} // namespace phosphor
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+namespace phosphor
+{
+namespace ipc
+{
+
+/** @class SlidingWindow
+ *  @brief Ring buffer of the latest samples with a running sum
+ *
+ *  The capacity is allocated once, pushing a sample replaces the oldest one
+ *  when full and updates the sum, so the average is O(1). Floating point
+ *  sums are recomputed once per wrap, so that rounding errors do not build
+ *  up over time.
+ */
+template <typename T>
+class SlidingWindow
+{
+  public:
+    using value_type = T;
+
+    explicit SlidingWindow(size_t capacity = 1) :
+        samples(std::max<size_t>(capacity, 1))
+    {}
+
+    /** @brief Add a sample, dropping the oldest one if full */
+    void push(T value)
+    {
+        if (count == samples.size())
+        {
+            sum -= samples[next];
+        }
+        else
+        {
+            count++;
+        }
+        samples[next] = value;
+        sum += value;
+        next = (next + 1) % samples.size();
+
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            if (next == 0 && full())
+            {
+                sum = std::accumulate(samples.begin(), samples.end(), T{});
+            }
+        }
+    }
+
+    /** @brief Drop all samples, the capacity is kept */
+    void clear()
+    {
+        count = 0;
+        next = 0;
+        sum = T{};
+    }
+
+    /** @brief Average of the samples, 0 if empty */
+    auto average() const -> double
+    {
+        return count == 0 ? 0 : static_cast<double>(sum) / count;
+    }
+
+    auto size() const -> size_t
+    {
+        return count;
+    }
+    auto capacity() const -> size_t
+    {
+        return samples.size();
+    }
+    auto empty() const -> bool
+    {
+        return count == 0;
+    }
+    auto full() const -> bool
+    {
+        return count == samples.size();
+    }
+
+  private:
+    /** @brief Samples, the oldest at next once full */
+    std::vector<T> samples;
+    /** @brief Slot of the next sample */
+    size_t next = 0;
+    /** @brief Number of samples */
+    size_t count = 0;
+    /** @brief Sum of the samples */
+    T sum{};
+};
+
+} // namespace ipc
+} // namespace phosphor
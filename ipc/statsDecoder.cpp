@@ -0,0 +1,139 @@
+#include "statsDecoder.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace phosphor
+{
+namespace ipc
+{
+
+static constexpr std::string_view peerAccounting =
+    "org.bus1.DBus.Debug.Stats.PeerAccounting";
+
+StatsDecoder::StatsDecoder(std::vector<std::string> keys) :
+    keys(std::move(keys)), counters(this->keys.size())
+{}
+
+auto StatsDecoder::decode(sd_bus_message* m, const handler_t& handler) -> bool
+{
+    if (sd_bus_message_enter_container(m, SD_BUS_TYPE_ARRAY, "{sv}") <= 0)
+    {
+        return false;
+    }
+    while (true)
+    {
+        auto rc = sd_bus_message_enter_container(m, SD_BUS_TYPE_DICT_ENTRY,
+                                                 "sv");
+        if (rc < 0)
+        {
+            return false;
+        }
+        if (rc == 0)
+        {
+            break;
+        }
+        const char* name = nullptr;
+        if (sd_bus_message_read_basic(m, SD_BUS_TYPE_STRING, &name) < 0)
+        {
+            return false;
+        }
+        if (name == peerAccounting)
+        {
+            if (!decodePeers(m, handler))
+            {
+                return false;
+            }
+        }
+        else if (sd_bus_message_skip(m, "v") < 0)
+        {
+            return false;
+        }
+        if (sd_bus_message_exit_container(m) < 0)
+        {
+            return false;
+        }
+    }
+    return sd_bus_message_exit_container(m) >= 0;
+}
+
+auto StatsDecoder::decodePeers(sd_bus_message* m, const handler_t& handler)
+    -> bool
+{
+    if (sd_bus_message_enter_container(m, SD_BUS_TYPE_VARIANT,
+                                       "a(sa{sv}a{su})") <= 0 ||
+        sd_bus_message_enter_container(m, SD_BUS_TYPE_ARRAY,
+                                       "(sa{sv}a{su})") <= 0)
+    {
+        return false;
+    }
+    while (true)
+    {
+        auto rc = sd_bus_message_enter_container(m, SD_BUS_TYPE_STRUCT,
+                                                 "sa{sv}a{su}");
+        if (rc < 0)
+        {
+            return false;
+        }
+        if (rc == 0)
+        {
+            break;
+        }
+        const char* peer = nullptr;
+        if (sd_bus_message_read_basic(m, SD_BUS_TYPE_STRING, &peer) < 0 ||
+            sd_bus_message_skip(m, "a{sv}") < 0 || !decodeCounters(m) ||
+            sd_bus_message_exit_container(m) < 0)
+        {
+            return false;
+        }
+        if (std::ranges::any_of(counters, [](const auto& counter) {
+                return counter.has_value();
+            }))
+        {
+            handler(peer, counters);
+        }
+    }
+    return sd_bus_message_exit_container(m) >= 0 &&
+           sd_bus_message_exit_container(m) >= 0;
+}
+
+auto StatsDecoder::decodeCounters(sd_bus_message* m) -> bool
+{
+    std::ranges::fill(counters, std::nullopt);
+    if (sd_bus_message_enter_container(m, SD_BUS_TYPE_ARRAY, "{su}") <= 0)
+    {
+        return false;
+    }
+    while (true)
+    {
+        auto rc = sd_bus_message_enter_container(m, SD_BUS_TYPE_DICT_ENTRY,
+                                                 "su");
+        if (rc < 0)
+        {
+            return false;
+        }
+        if (rc == 0)
+        {
+            break;
+        }
+        const char* key = nullptr;
+        uint32_t value = 0;
+        if (sd_bus_message_read_basic(m, SD_BUS_TYPE_STRING, &key) < 0 ||
+            sd_bus_message_read_basic(m, SD_BUS_TYPE_UINT32, &value) < 0 ||
+            sd_bus_message_exit_container(m) < 0)
+        {
+            return false;
+        }
+        for (size_t index = 0; index < keys.size(); index++)
+        {
+            if (keys[index] == key)
+            {
+                counters[index] = value;
+            }
+        }
+    }
+    return sd_bus_message_exit_container(m) >= 0;
+}
+
+} // namespace ipc
+} // namespace phosphor
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <systemd/sd-bus.h>
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace phosphor
+{
+namespace ipc
+{
+
+/** @class StatsDecoder
+ *  @brief Decodes the peer counters of a GetStats reply in a single pass
+ *
+ *  The reply is an a{sv}, whose PeerAccounting entry holds an
+ *  a(sa{sv}a{su}) with the name, properties and counters of every peer. The
+ *  containers are walked straight from the message, the other entries, the
+ *  peer properties and the counters which are not monitored are skipped, so
+ *  that nothing is allocated per peer or per counter.
+ */
+class StatsDecoder
+{
+  public:
+    /** @brief Counters of a peer, unset if the peer has none of the key */
+    using counters_t = std::span<const std::optional<uint32_t>>;
+    /** @brief Handler of the counters of a peer */
+    using handler_t =
+        std::function<void(std::string_view peer, counters_t counters)>;
+
+    /** @brief Decode the given counters, duplicate keys are allowed */
+    explicit StatsDecoder(std::vector<std::string> keys);
+
+    /** @brief Decode a GetStats reply, the handler is called for every peer
+     *         with at least one of the counters, in the order of the keys
+     *
+     *  @return False if the reply is malformed
+     */
+    auto decode(sd_bus_message* m, const handler_t& handler) -> bool;
+
+  private:
+    /** @brief Decode the PeerAccounting array */
+    auto decodePeers(sd_bus_message* m, const handler_t& handler) -> bool;
+    /** @brief Decode the counters of a peer */
+    auto decodeCounters(sd_bus_message* m) -> bool;
+
+    /** @brief Monitored counters */
+    std::vector<std::string> keys;
+    /** @brief Counters of the current peer, by key index */
+    std::vector<std::optional<uint32_t>> counters;
+};
+
+} // namespace ipc
+} // namespace phosphor
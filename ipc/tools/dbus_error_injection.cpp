@@ -3,8 +3,10 @@
 #include <sdbusplus/bus/match.hpp>
 
 #include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <memory>
+#include <string_view>
 #include <thread>
 PHOSPHOR_LOG2_USING;
 // Callback function to handle signals
@@ -28,11 +30,37 @@ void signalHandler(sdbusplus::message::message& msg)
     }
 }
 
-int main()
+// Emit small signals at the given rate, to load the bus with many messages
+// instead of queued bytes
+[[noreturn]] void flood(sdbusplus::bus_t& bus, unsigned long rate)
 {
-    // Create a new default system bus connection
+    lg2::info("Emitting {RATE} signals per second", "RATE", rate);
+    while (true)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned long i = 0; i < rate; i++)
+        {
+            auto msg = bus.new_signal("/xyz/openbmc_project/ipc_test",
+                                      "xyz.openbmc_project.IPCTest", "Flood");
+            msg.signal_send();
+        }
+        bus.flush();
+        std::this_thread::sleep_until(start + std::chrono::seconds(1));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // Create a new default system bus connection, DBUS_SYSTEM_BUS_ADDRESS
+    // may point it to a private bus
     auto bus = sdbusplus::bus::new_default_system();
 
+    // inject-error --flood <signals per second>
+    if (argc == 3 && std::string_view(argv[1]) == "--flood")
+    {
+        flood(bus, std::strtoul(argv[2], nullptr, 10));
+    }
+
     // Define the match rule for signals
     std::string matchRule = "type='signal', "
                             "path_namespace='/xyz/openbmc_project'";
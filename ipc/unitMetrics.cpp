@@ -0,0 +1,132 @@
+#include "unitMetrics.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+#include <sdbusplus/message.hpp>
+
+#include <cmath>
+#include <limits>
+#include <set>
+#include <tuple>
+
+namespace phosphor
+{
+namespace ipc
+{
+
+PHOSPHOR_LOG2_USING;
+
+UnitMetrics::UnitMetrics(sdbusplus::bus_t& bus, const IPCConfig& ipcConfig) :
+    bus(bus), ipcConfig(ipcConfig)
+{}
+
+void UnitMetrics::add(const std::string& unit, size_t param, double value,
+                      bool warning, bool critical)
+{
+    auto& entry = units[unit];
+    if (entry.samples.empty())
+    {
+        entry.samples.resize(ipcConfig.paramConfig.size());
+    }
+    entry.seen = true;
+
+    auto& sample = entry.samples[param];
+    sample.value += value;
+    sample.valid = true;
+    sample.warning |= warning;
+    sample.critical |= critical;
+}
+
+void UnitMetrics::commit()
+{
+    for (auto it = units.begin(); it != units.end();)
+    {
+        auto& [name, unit] = *it;
+        if (!unit.seen)
+        {
+            if (++unit.missed > retainReads)
+            {
+                lg2::debug("Removing IPC metrics of unit {UNIT}", "UNIT", name);
+                it = units.erase(it);
+                continue;
+            }
+            ++it;
+            continue;
+        }
+        unit.seen = false;
+        unit.missed = 0;
+
+        if (unit.metrics.empty())
+        {
+            create(name, unit);
+        }
+        for (size_t param = 0; param < unit.metrics.size(); param++)
+        {
+            publish(*unit.metrics[param], param, unit.samples[param]);
+            unit.samples[param] = Sample{};
+        }
+        ++it;
+    }
+}
+
+auto UnitMetrics::getPath(const std::string& unit, size_t param) const
+    -> std::string
+{
+    return sdbusplus::message::object_path(ipcMetricPath) / ipcConfig.name /
+           unit / ipcConfig.paramConfig[param].name;
+}
+
+void UnitMetrics::create(const std::string& name, Unit& unit)
+{
+    lg2::debug("Creating IPC metrics of unit {UNIT}", "UNIT", name);
+    for (size_t param = 0; param < ipcConfig.paramConfig.size(); param++)
+    {
+        const auto& cfg = ipcConfig.paramConfig[param];
+        auto path = getPath(name, param);
+        auto metric = std::make_unique<MetricIntf>(
+            bus, path.c_str(), MetricIntf::action::defer_emit);
+
+        ThresholdIntf::ValueMap thresholds;
+        auto bound = cfg.predicate.bound();
+        if (std::isfinite(cfg.criticalHigh))
+        {
+            thresholds[ThresholdIntf::Type::Critical][bound] =
+                cfg.criticalHigh;
+        }
+        if (std::isfinite(cfg.warningHigh))
+        {
+            thresholds[ThresholdIntf::Type::Warning][bound] = cfg.warningHigh;
+        }
+        metric->ThresholdIntf::value(thresholds, true);
+        metric->ValueIntf::value(std::numeric_limits<double>::quiet_NaN(),
+                                 true);
+        metric->emit_object_added();
+        unit.metrics.emplace_back(std::move(metric));
+    }
+}
+
+void UnitMetrics::publish(MetricIntf& metric, size_t param,
+                          const Sample& sample)
+{
+    // NaN never compares equal, do not signal it again
+    if (sample.valid || !std::isnan(metric.ValueIntf::value()))
+    {
+        metric.ValueIntf::value(sample.valid
+                                    ? sample.value
+                                    : std::numeric_limits<double>::quiet_NaN());
+    }
+
+    auto bound = ipcConfig.paramConfig[param].predicate.bound();
+    std::set<std::tuple<ThresholdIntf::Type, ThresholdIntf::Bound>> asserted;
+    if (sample.critical)
+    {
+        asserted.emplace(ThresholdIntf::Type::Critical, bound);
+    }
+    if (sample.warning)
+    {
+        asserted.emplace(ThresholdIntf::Type::Warning, bound);
+    }
+    metric.ThresholdIntf::asserted(asserted);
+}
+
+} // namespace ipc
+} // namespace phosphor
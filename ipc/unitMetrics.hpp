@@ -0,0 +1,106 @@
+#pragma once
+#include "ipcConfig.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/server/object.hpp>
+#include <xyz/openbmc_project/Common/Threshold/server.hpp>
+#include <xyz/openbmc_project/Metric/Value/server.hpp>
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace phosphor
+{
+namespace ipc
+{
+
+using ValueIntf = sdbusplus::server::xyz::openbmc_project::metric::Value;
+using ThresholdIntf =
+    sdbusplus::server::xyz::openbmc_project::common::Threshold;
+using MetricIntf = sdbusplus::server::object_t<ValueIntf, ThresholdIntf>;
+
+/** @brief Root of the IPC metric objects */
+static constexpr auto ipcMetricPath = "/xyz/openbmc_project/metric/ipc";
+
+/** @class UnitMetrics
+ *  @brief Publishes the monitored parameters of the peers as Metric.Value
+ *         objects, aggregated by systemd unit
+ *
+ *  Every read of the bus reports the peer values with add(), and commit()
+ *  publishes one object per unit and parameter, valued with the sum over
+ *  the peers of the unit and asserting the thresholds crossed by any of
+ *  them. Objects are only created and removed in commit(), so at most once
+ *  per read, and the objects of a unit are kept for retainReads reads after
+ *  its last peer left, so that restarting services do not remove and add
+ *  them again.
+ */
+class UnitMetrics
+{
+  public:
+    UnitMetrics() = delete;
+    UnitMetrics(const UnitMetrics&) = delete;
+    UnitMetrics& operator=(const UnitMetrics&) = delete;
+    UnitMetrics(UnitMetrics&&) = delete;
+    UnitMetrics& operator=(UnitMetrics&&) = delete;
+    ~UnitMetrics() = default;
+
+    UnitMetrics(sdbusplus::bus_t& bus, const IPCConfig& ipcConfig);
+
+    /** @brief Add the value of a parameter of a peer of a unit */
+    void add(const std::string& unit, size_t param, double value,
+             bool warning, bool critical);
+    /** @brief Publish the values added since the last commit */
+    void commit();
+
+    /** @brief Get the object path of a parameter of a unit */
+    auto getPath(const std::string& unit, size_t param) const -> std::string;
+    /** @brief Number of published units */
+    auto size() const -> size_t
+    {
+        return units.size();
+    }
+
+    /** @brief Reads a unit without peers is kept for */
+    static constexpr size_t retainReads = 2;
+
+  private:
+    /** @brief Aggregated value of a parameter in the current read */
+    struct Sample
+    {
+        double value = 0;
+        bool valid = false;
+        bool warning = false;
+        bool critical = false;
+    };
+
+    /** @brief Published objects of a unit */
+    struct Unit
+    {
+        /** @brief Objects by parameter index, created on the first commit */
+        std::vector<std::unique_ptr<MetricIntf>> metrics;
+        /** @brief Samples by parameter index */
+        std::vector<Sample> samples;
+        /** @brief Set when a peer of the unit was added in the current read */
+        bool seen = false;
+        /** @brief Consecutive reads without peers */
+        size_t missed = 0;
+    };
+
+    /** @brief Create the objects of a unit */
+    void create(const std::string& name, Unit& unit);
+    /** @brief Publish a sample on the object of a parameter */
+    void publish(MetricIntf& metric, size_t param, const Sample& sample);
+
+    /** @brief sdbusplus bus client connection */
+    sdbusplus::bus_t& bus;
+    /** @brief Sensor config from config file */
+    const IPCConfig& ipcConfig;
+    /** @brief Units by name */
+    std::map<std::string, Unit> units;
+};
+
+} // namespace ipc
+} // namespace phosphor
@@ -0,0 +1,185 @@
+#include "unitResolver.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+#include <sdbusplus/message.hpp>
+
+#include <charconv>
+#include <system_error>
+#include <utility>
+
+namespace phosphor
+{
+namespace ipc
+{
+
+PHOSPHOR_LOG2_USING;
+
+UnitResolver::UnitResolver(sdbusplus::asio::connection& conn) :
+    conn(conn),
+    nameOwnerChanged(conn,
+                     sdbusplus::bus::match::rules::nameOwnerChanged(),
+                     [this](sdbusplus::message_t& msg) {
+    std::string name;
+    std::string oldOwner;
+    std::string newOwner;
+    msg.read(name, oldOwner, newOwner);
+    if (newOwner.empty())
+    {
+        forget(name);
+    }
+})
+{}
+
+void UnitResolver::resolve(const std::string& connName, callback_t callback)
+{
+    if (auto pid = pids.find(connName); pid != pids.end())
+    {
+        if (auto unit = units.find(pid->second); unit != units.end())
+        {
+            callback(unit->second.name);
+            return;
+        }
+    }
+
+    auto& callbacks = pending[connName];
+    callbacks.emplace_back(std::move(callback));
+    if (callbacks.size() > 1)
+    {
+        // A lookup is already in flight
+        return;
+    }
+
+    conn.async_method_call(
+        [this, connName](const boost::system::error_code ec, uint32_t pid) {
+        if (ec)
+        {
+            lg2::error("GetConnectionUnixProcessID for {SERVICE} failed: "
+                       "{ERROR}",
+                       "SERVICE", connName, "ERROR", ec.message());
+            fail(connName);
+            return;
+        }
+        resolvePid(connName, pid);
+    },
+        "org.freedesktop.DBus", "/org/freedesktop/DBus", "org.freedesktop.DBus",
+        "GetConnectionUnixProcessID", connName);
+}
+
+void UnitResolver::resolvePid(const std::string& connName, uint32_t pid)
+{
+    if (auto unit = units.find(pid); unit != units.end())
+    {
+        // Another connection of the same process
+        complete(connName, pid, unit->second.name);
+        return;
+    }
+
+    conn.async_method_call(
+        [this, connName, pid](const boost::system::error_code ec,
+                              sdbusplus::message::object_path path) {
+        if (ec)
+        {
+            lg2::error("GetUnitByPID for {PID} failed: {ERROR}", "PID", pid,
+                       "ERROR", ec.message());
+            fail(connName);
+            return;
+        }
+        // e.g. unit object path looks like
+        // /org/freedesktop/systemd1/unit/phosphor_2dcertificate_2dmanager_40bmcweb_2eservice
+        std::string unit = unescape(path.filename());
+        if (unit.empty())
+        {
+            lg2::error("Not able to find unit name for PID: {PID}", "PID",
+                       pid);
+            fail(connName);
+            return;
+        }
+        lg2::info("Unit name: {UNIT}", "UNIT", unit);
+        complete(connName, pid, unit);
+    },
+        "org.freedesktop.systemd1", "/org/freedesktop/systemd1",
+        "org.freedesktop.systemd1.Manager", "GetUnitByPID", pid);
+}
+
+void UnitResolver::complete(const std::string& connName, uint32_t pid,
+                            const std::string& unit)
+{
+    std::vector<callback_t> callbacks;
+    if (auto node = pending.extract(connName); !node.empty())
+    {
+        callbacks = std::move(node.mapped());
+    }
+
+    // The connection may have left the bus during the lookup, the result is
+    // still passed on but not cached
+    if (!left.erase(connName) && !pids.contains(connName))
+    {
+        pids[connName] = pid;
+        auto& cached = units[pid];
+        cached.name = unit;
+        cached.connections++;
+    }
+    for (const auto& callback : callbacks)
+    {
+        callback(unit);
+    }
+}
+
+void UnitResolver::fail(const std::string& connName)
+{
+    // The lookup is retried on the next request
+    pending.erase(connName);
+    left.erase(connName);
+}
+
+void UnitResolver::forget(const std::string& connName)
+{
+    if (pending.contains(connName))
+    {
+        left.insert(connName);
+    }
+
+    auto pid = pids.find(connName);
+    if (pid == pids.end())
+    {
+        return;
+    }
+    if (auto unit = units.find(pid->second);
+        unit != units.end() && --unit->second.connections == 0)
+    {
+        units.erase(unit);
+    }
+    pids.erase(pid);
+}
+
+auto UnitResolver::unescape(std::string_view label) -> std::string
+{
+    // An empty label is encoded as a single underscore
+    if (label == "_")
+    {
+        return {};
+    }
+
+    std::string result;
+    result.reserve(label.size());
+    for (size_t i = 0; i < label.size(); i++)
+    {
+        unsigned char byte = 0;
+        if (label[i] == '_' && i + 2 < label.size())
+        {
+            auto first = label.data() + i + 1;
+            auto [end, ec] = std::from_chars(first, first + 2, byte, 16);
+            if (ec == std::errc() && end == first + 2)
+            {
+                result.push_back(static_cast<char>(byte));
+                i += 2;
+                continue;
+            }
+        }
+        result.push_back(label[i]);
+    }
+    return result;
+}
+
+} // namespace ipc
+} // namespace phosphor
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <sdbusplus/asio/connection.hpp>
+#include <sdbusplus/bus/match.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace phosphor
+{
+namespace ipc
+{
+
+/** @class UnitResolver
+ *  @brief Resolves D-Bus connection names to the systemd unit owning them
+ *
+ *  The PID of a connection and the unit of a PID are cached, so that
+ *  repeated threshold hits need no bus call. Concurrent requests for the
+ *  same connection share one lookup. Connections are dropped from the cache
+ *  when NameOwnerChanged reports them gone, along with the unit of their PID
+ *  once no cached connection uses it, as the PID may be reused.
+ */
+class UnitResolver
+{
+  public:
+    using callback_t = std::function<void(const std::string& unit)>;
+
+    UnitResolver() = delete;
+    UnitResolver(const UnitResolver&) = delete;
+    UnitResolver& operator=(const UnitResolver&) = delete;
+    UnitResolver(UnitResolver&&) = delete;
+    UnitResolver& operator=(UnitResolver&&) = delete;
+    ~UnitResolver() = default;
+
+    explicit UnitResolver(sdbusplus::asio::connection& conn);
+
+    /** @brief Resolve the unit of a connection, the callback is not called
+     *         if it cannot be resolved */
+    void resolve(const std::string& connName, callback_t callback);
+
+    /** @brief Decode a systemd object path label in a single pass, e.g.
+     *         phosphor_2dlogging_2eservice to phosphor-logging.service */
+    static auto unescape(std::string_view label) -> std::string;
+
+  private:
+    /** @brief Cached unit of a PID */
+    struct Unit
+    {
+        std::string name;
+        /** @brief Number of cached connections of the PID */
+        size_t connections = 0;
+    };
+
+    /** @brief Resolve the unit of the PID of a connection */
+    void resolvePid(const std::string& connName, uint32_t pid);
+    /** @brief Cache the result of a lookup and run the pending callbacks */
+    void complete(const std::string& connName, uint32_t pid,
+                  const std::string& unit);
+    /** @brief Drop the pending callbacks of a failed lookup */
+    void fail(const std::string& connName);
+    /** @brief Drop a connection which left the bus */
+    void forget(const std::string& connName);
+
+    /** @brief D-Bus connection for the lookups */
+    sdbusplus::asio::connection& conn;
+    /** @brief PID by connection name */
+    std::unordered_map<std::string, uint32_t> pids;
+    /** @brief Unit by PID */
+    std::unordered_map<uint32_t, Unit> units;
+    /** @brief Callbacks waiting for a lookup by connection name */
+    std::unordered_map<std::string, std::vector<callback_t>> pending;
+    /** @brief Connections which left the bus during their lookup */
+    std::unordered_set<std::string> left;
+    /** @brief Match for connections leaving the bus */
+    sdbusplus::bus::match_t nameOwnerChanged;
+};
+
+} // namespace ipc
+} // namespace phosphor
@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+
+"""
+Generate the compile-time default health metric config.
+
+Reads the default bmc_health_config JSON and writes a C++ header with a
+constexpr table of the default metrics, see
+health_metric_config_defaults.hpp for the table types.
+"""
+
+import argparse
+import hashlib
+import json
+
+# Threshold types accepted in the config, see health_metric_config.cpp
+THRESHOLD_TYPES = ["Critical", "Warning"]
+THRESHOLD_BOUNDS = ["Lower", "Upper"]
+MAX_THRESHOLDS = len(THRESHOLD_TYPES) * len(THRESHOLD_BOUNDS)
+
+
+def cpp_string(value):
+    return json.dumps(str(value))
+
+
+def cpp_double(value):
+    return repr(float(value))
+
+
+def cpp_bool(value):
+    return "true" if value else "false"
+
+
+def threshold(key, config):
+    type_, _, bound = key.partition("_")
+    if type_ not in THRESHOLD_TYPES or bound not in THRESHOLD_BOUNDS:
+        raise ValueError(f"Invalid ThresholdType: {key}")
+
+    def value(key, default, convert):
+        return convert(config[key]) if key in config else default
+
+    rate_limit = config.get("Rate_limit", {})
+    return (
+        "{"
+        + ", ".join(
+            [
+                f"ThresholdIntf::Type::{type_}",
+                f"ThresholdIntf::Bound::{bound}",
+                cpp_double(config.get("Value", 100.0)),
+                cpp_bool(config.get("Log", False)),
+                cpp_string(config.get("Target", "")),
+                value(
+                    "Deassert_hysteresis",
+                    "Threshold::defaults::deassertHysteresis",
+                    cpp_double,
+                ),
+                value(
+                    "Hold_time",
+                    "Threshold::defaults::holdTime",
+                    lambda v: f"std::chrono::seconds({int(v)})",
+                ),
+                value("Flap_count", "Threshold::defaults::flapCount", str),
+                value(
+                    "Flap_window",
+                    "Threshold::defaults::flapWindow",
+                    lambda v: f"std::chrono::seconds({int(v)})",
+                ),
+                str(rate_limit["Burst"])
+                if "Burst" in rate_limit
+                else "Threshold::defaults::rateLimitBurst",
+                f"std::chrono::seconds({int(rate_limit['Period'])})"
+                if "Period" in rate_limit
+                else "Threshold::defaults::rateLimitPeriod",
+            ]
+        )
+        + "}"
+    )
+
+
+def metric(name, config):
+    thresholds = [
+        threshold(key, value)
+        for key, value in config.get("Threshold", {}).items()
+    ]
+    if len(thresholds) > MAX_THRESHOLDS:
+        raise ValueError(f"Too many thresholds for {name}")
+
+    def value(key, default, convert):
+        return convert(config[key]) if key in config else default
+
+    fields = [
+        f".name = {cpp_string(name)}",
+        f".type = metricType({cpp_string(name)})",
+        f".subType = metricSubType({cpp_string(name)})",
+        ".windowSize = "
+        + value("Window_size", "HealthMetric::defaults::windowSize", str),
+        ".hysteresis = "
+        + value("Hysteresis", "HealthMetric::defaults::hysteresis", cpp_double),
+        ".frequency = "
+        + value("Frequency", "HealthMetric::defaults::frequency", str),
+        f".path = {cpp_string(config.get('Path', ''))}",
+        f".binaryName = {cpp_string(config.get('BinaryName', ''))}",
+        f".thresholdCount = {len(thresholds)}",
+        ".thresholds = {{" + ", ".join(thresholds) + "}}",
+    ]
+    return "    DefaultMetric{\n        " + ",\n        ".join(fields) + "},"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("input", help="default health config JSON")
+    parser.add_argument("output", help="generated C++ header")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        text = f.read()
+    configs = json.loads(text)
+
+    # Sorted by name, the order in which the JSON config is iterated
+    metrics = [metric(name, configs[name]) for name in sorted(configs)]
+    digest = hashlib.sha256(text).hexdigest()
+
+    with open(args.output, "w") as f:
+        f.write(
+            f"""// Generated by gen_default_config.py, do not edit.
+#pragma once
+
+#include "health_metric_config_defaults.hpp"
+
+#include <array>
+#include <string_view>
+
+namespace phosphor::health::metric::config
+{{
+
+/** @brief SHA-256 of the JSON the defaults were generated from */
+inline constexpr std::string_view defaultHealthMetricDigest =
+    "{digest}";
+
+/** @brief Built-in default health metric configs */
+inline constexpr std::array<DefaultMetric, {len(metrics)}> defaultHealthMetrics = {{{{
+{chr(10).join(metrics)}
+}}}};
+
+}} // namespace phosphor::health::metric::config
+"""
+        )
+
+
+if __name__ == "__main__":
+    main()
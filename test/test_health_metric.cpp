@@ -94,3 +94,190 @@ TEST_F(HealthMetricTest, TestMetricThresholdChange)
     // Go below warning threshold
     metric->update(MValue(1199, 1500));
 }
+
+TEST_F(HealthMetricTest, TestMetricThresholdWrite)
+{
+    sdbusplus::server::manager_t objManager(bus, objPath.c_str());
+    bus.request_name(busName);
+
+    EXPECT_CALL(sdbusMock, sd_bus_emit_properties_changed_strv(
+                               IsNull(), StrEq(objPath), _, NotNull()))
+        .WillRepeatedly(testing::Return(0));
+    EXPECT_CALL(sdbusMock,
+                sd_bus_message_new_signal(_, _, StrEq(objPath),
+                                          StrEq(ThresholdIntf::interface),
+                                          StrEq("AssertionChanged")))
+        .Times(1);
+
+    auto metric = std::make_unique<HealthMetric>(bus, Type::cpu, config,
+                                                 paths_t());
+    using values_t = std::map<ThresholdIntf::Type,
+                              std::map<ThresholdIntf::Bound, double>>;
+    auto criticalUpper = [](double value) {
+        return values_t{
+            {ThresholdIntf::Type::Critical,
+             {{ThresholdIntf::Bound::Upper, value}}}};
+    };
+
+    // No sample yet to convert the absolute value against
+    EXPECT_ANY_THROW(metric->value(criticalUpper(900)));
+
+    // Below both thresholds
+    metric->update(MValue(1000, 1500));
+
+    // Only configured thresholds may be written
+    EXPECT_ANY_THROW(metric->value(values_t{
+        {ThresholdIntf::Type::Critical,
+         {{ThresholdIntf::Bound::Lower, 1.0}}}}));
+
+    // Lower the critical threshold to 60%, the next sample asserts it
+    metric->value(criticalUpper(900));
+    metric->update(MValue(1000, 1500));
+}
+
+TEST_F(HealthMetricTest, TestMetricDeassertHysteresis)
+{
+    sdbusplus::server::manager_t objManager(bus, objPath.c_str());
+    bus.request_name(busName);
+
+    EXPECT_CALL(sdbusMock, sd_bus_emit_properties_changed_strv(
+                               IsNull(), StrEq(objPath), _, NotNull()))
+        .WillRepeatedly(testing::Return(0));
+    // Critical and warning assert once, the dip below the critical limit
+    // stays within its deassert hysteresis
+    EXPECT_CALL(sdbusMock,
+                sd_bus_message_new_signal(_, _, StrEq(objPath),
+                                          StrEq(ThresholdIntf::interface),
+                                          StrEq("AssertionChanged")))
+        .Times(2);
+
+    config.thresholds
+        .at({ThresholdIntf::Type::Critical, ThresholdIntf::Bound::Upper})
+        .deassertHysteresis = 5.0;
+    auto metric = std::make_unique<HealthMetric>(bus, Type::cpu, config,
+                                                 paths_t());
+    metric->update(MValue(1351, 1500));
+    metric->update(MValue(1320, 1500));
+    metric->update(MValue(1351, 1500));
+}
+
+TEST_F(HealthMetricTest, TestMetricFlapping)
+{
+    sdbusplus::server::manager_t objManager(bus, objPath.c_str());
+    bus.request_name(busName);
+
+    EXPECT_CALL(sdbusMock, sd_bus_emit_properties_changed_strv(
+                               IsNull(), StrEq(objPath), _, NotNull()))
+        .WillRepeatedly(testing::Return(0));
+    // Warning asserts once, critical asserts, deasserts and asserts again
+    // before it is held asserted for flapping
+    EXPECT_CALL(sdbusMock,
+                sd_bus_message_new_signal(_, _, StrEq(objPath),
+                                          StrEq(ThresholdIntf::interface),
+                                          StrEq("AssertionChanged")))
+        .Times(4);
+
+    config.thresholds
+        .at({ThresholdIntf::Type::Critical, ThresholdIntf::Bound::Upper})
+        .flapCount = 3;
+    auto metric = std::make_unique<HealthMetric>(bus, Type::cpu, config,
+                                                 paths_t());
+    for (auto i = 0; i < 3; i++)
+    {
+        metric->update(MValue(1351, 1500));
+        metric->update(MValue(1320, 1500));
+    }
+}
+
+TEST_F(HealthMetricTest, TestMetricFlappingOnDeassert)
+{
+    sdbusplus::server::manager_t objManager(bus, objPath.c_str());
+    bus.request_name(busName);
+
+    EXPECT_CALL(sdbusMock, sd_bus_emit_properties_changed_strv(
+                               IsNull(), StrEq(objPath), _, NotNull()))
+        .WillRepeatedly(testing::Return(0));
+    // Warning and critical assert, the deassert which makes critical flap is
+    // not signaled
+    EXPECT_CALL(sdbusMock,
+                sd_bus_message_new_signal(_, _, StrEq(objPath),
+                                          StrEq(ThresholdIntf::interface),
+                                          StrEq("AssertionChanged")))
+        .Times(2);
+
+    config.thresholds
+        .at({ThresholdIntf::Type::Critical, ThresholdIntf::Bound::Upper})
+        .flapCount = 2;
+    auto metric = std::make_unique<HealthMetric>(bus, Type::cpu, config,
+                                                 paths_t());
+    metric->update(MValue(1351, 1500));
+    metric->update(MValue(1320, 1500));
+    EXPECT_TRUE(metric->ThresholdIntf::asserted().contains(
+        {ThresholdIntf::Type::Critical, ThresholdIntf::Bound::Upper}));
+}
+
+TEST_F(HealthMetricTest, TestMetricBatchedSignals)
+{
+    sdbusplus::server::manager_t objManager(bus, objPath.c_str());
+    bus.request_name(busName);
+    batch::Batcher batcher(bus);
+    HealthMetric::setBatcher(&batcher);
+
+    auto metric = std::make_unique<HealthMetric>(bus, Type::cpu, config,
+                                                 paths_t());
+    {
+        // Nothing is sent before the end of the tick
+        EXPECT_CALL(sdbusMock,
+                    sd_bus_emit_properties_changed_strv(_, _, _, _))
+            .Times(0);
+        // Value, the threshold values and assertions change
+        metric->update(MValue(1351, 1500));
+        testing::Mock::VerifyAndClearExpectations(&sdbusMock);
+    }
+
+    // One signal per interface, with all of its changed properties
+    EXPECT_CALL(sdbusMock, sd_bus_emit_properties_changed_strv(
+                               IsNull(), StrEq(objPath),
+                               StrEq(ValueIntf::interface), NotNull()))
+        .WillOnce(Invoke(
+            [](sd_bus*, const char*, const char*, const char** names) {
+        EXPECT_STREQ(names[0], "Value");
+        EXPECT_EQ(names[1], nullptr);
+        return 0;
+    }));
+    EXPECT_CALL(sdbusMock, sd_bus_emit_properties_changed_strv(
+                               IsNull(), StrEq(objPath),
+                               StrEq(ThresholdIntf::interface), NotNull()))
+        .WillOnce(Invoke(
+            [](sd_bus*, const char*, const char*, const char** names) {
+        EXPECT_STREQ(names[0], "Value");
+        EXPECT_STREQ(names[1], "Asserted");
+        EXPECT_EQ(names[2], nullptr);
+        return 0;
+    }));
+    batcher.flush();
+    EXPECT_EQ(batcher.stats().signals, 2);
+    EXPECT_GT(batcher.stats().changes, batcher.stats().signals);
+
+    HealthMetric::setBatcher(nullptr);
+}
+
+TEST_F(HealthMetricTest, TestMetricLateAssociations)
+{
+    sdbusplus::server::manager_t objManager(bus, objPath.c_str());
+    bus.request_name(busName);
+    EXPECT_CALL(sdbusMock, sd_bus_emit_properties_changed_strv(_, _, _, _))
+        .WillRepeatedly(testing::Return(0));
+
+    // Created before the mapper responded
+    auto metric = std::make_unique<HealthMetric>(bus, Type::cpu, config,
+                                                 paths_t());
+    EXPECT_TRUE(metric->AssociationIntf::associations().empty());
+
+    const auto bmcPath = "/xyz/openbmc_project/inventory/system/bmc";
+    metric->setAssociations({bmcPath});
+    auto associations = metric->AssociationIntf::associations();
+    ASSERT_EQ(associations.size(), 1);
+    EXPECT_EQ(associations[0],
+              std::make_tuple("measuring", "measured_by", bmcPath));
+}
@@ -13,11 +13,31 @@ using PathInterface =
     sdbusplus::common::xyz::openbmc_project::metric::Value::namespace_path;
 using ThresholdIntf =
     sdbusplus::server::xyz::openbmc_project::common::Threshold;
+using ::testing::_;
+using ::testing::ElementsAre;
 using ::testing::Invoke;
 using ::testing::IsNull;
 using ::testing::NotNull;
 using ::testing::StrEq;
 
+/** @brief Records the metrics added and removed */
+class RecordingSink : public MetricIntf::MetricSink
+{
+  public:
+    void added(const MetricIntf::HealthMetric& metric) override
+    {
+        addedNames.push_back(metric.getName());
+    }
+    void updated(const MetricIntf::HealthMetric& /*metric*/) override {}
+    void removed(const MetricIntf::HealthMetric& metric) override
+    {
+        removedNames.push_back(metric.getName());
+    }
+
+    std::vector<std::string> addedNames;
+    std::vector<std::string> removedNames;
+};
+
 class HealthMetricCollectionTest : public ::testing::Test
 {
   public:
@@ -37,6 +57,8 @@ class HealthMetricCollectionTest : public ::testing::Test
         sdbusplus::server::manager_t objManager(bus, objPath);
         bus.request_name(busName);
 
+        // Parse the configs, the cache of the host may be stale
+        ConfigIntf::setCacheDirectory("");
         configs = ConfigIntf::getHealthMetricConfigs();
         EXPECT_THAT(configs.size(), testing::Ge(1));
         // Update the health metric window size to 1 and path for test purposes
@@ -165,3 +187,102 @@ TEST_F(HealthMetricCollectionTest, TestThresholdAsserted)
 
     createCollection();
 }
+
+TEST_F(HealthMetricCollectionTest, TestReconfigure)
+{
+    // Sinks stay registered for the whole process
+    static RecordingSink sink;
+    static bool registered = false;
+    if (!registered)
+    {
+        MetricIntf::HealthMetric::addSink(sink);
+        registered = true;
+    }
+
+    auto memory = [](const std::string& name, MetricIntf::SubType subType) {
+        ConfigIntf::HealthMetric config;
+        config.name = name;
+        config.subType = subType;
+        config.windowSize = 1;
+        return config;
+    };
+    CollectionIntf::configs_t configList = {
+        memory("Memory_Free", MetricIntf::SubType::memoryFree),
+        memory("Memory_Available", MetricIntf::SubType::memoryAvailable),
+        memory("Memory_Total", MetricIntf::SubType::memoryTotal)};
+
+    EXPECT_CALL(sdbusMock, sd_bus_emit_properties_changed_strv(
+                               IsNull(), NotNull(), NotNull(), NotNull()))
+        .WillRepeatedly(testing::Return(0));
+    MetricIntf::paths_t bmcPaths = {};
+    CollectionIntf::HealthMetricCollection collection(
+        bus, MetricIntf::Type::memory, configList, bmcPaths);
+    EXPECT_THAT(sink.addedNames, ElementsAre("Memory_Free", "Memory_Available",
+                                             "Memory_Total"));
+    sink.addedNames.clear();
+
+    // Only the retuned metric changes its tuning properties in place
+    const auto availablePath =
+        std::string(PathInterface::value) + "/bmc/" +
+        PathInterface::available_memory;
+    EXPECT_CALL(sdbusMock, sd_bus_emit_properties_changed_strv(
+                               IsNull(), _, StrEq(MetricIntf::TuningIntf), _))
+        .Times(0);
+    EXPECT_CALL(sdbusMock, sd_bus_emit_properties_changed_strv(
+                               IsNull(), StrEq(availablePath),
+                               StrEq(MetricIntf::TuningIntf), NotNull()))
+        .Times(2)
+        .WillRepeatedly(testing::Return(0));
+
+    configList[1].hysteresis = 5.0;
+    configList[2] = memory("Memory_Shared", MetricIntf::SubType::memoryShared);
+    collection.reconfigure(configList);
+
+    EXPECT_THAT(sink.addedNames, ElementsAre("Memory_Shared"));
+    EXPECT_THAT(sink.removedNames, ElementsAre("Memory_Total"));
+
+    // Applying the same configs again changes nothing
+    sink.addedNames.clear();
+    sink.removedNames.clear();
+    collection.reconfigure(configList);
+    EXPECT_TRUE(sink.addedNames.empty());
+    EXPECT_TRUE(sink.removedNames.empty());
+}
+
+TEST_F(HealthMetricCollectionTest, TestPatternPathCollision)
+{
+    static RecordingSink sink;
+    static bool registered = false;
+    if (!registered)
+    {
+        MetricIntf::HealthMetric::addSink(sink);
+        registered = true;
+    }
+
+    auto process = [](const std::string& name, const std::string& binaryName) {
+        ConfigIntf::HealthMetric config;
+        config.name = name;
+        config.subType = MetricIntf::SubType::cpuProcesses;
+        config.windowSize = 1;
+        config.binaryName = binaryName;
+        return config;
+    };
+    CollectionIntf::configs_t configList = {
+        process("ProcessCPU_Services", "/^([Ff]oo|BAR)$/"),
+        process("Cpu_Others", "fo*"), process("ProcessCPU_Bar", "bar")};
+
+    EXPECT_CALL(sdbusMock, sd_bus_emit_properties_changed_strv(
+                               IsNull(), NotNull(), NotNull(), NotNull()))
+        .WillRepeatedly(testing::Return(0));
+    MetricIntf::paths_t bmcPaths = {};
+    CollectionIntf::HealthMetricCollection collection(
+        bus, MetricIntf::Type::processCPU, configList, bmcPaths);
+    sink.addedNames.clear();
+
+    // Names differing in case or prefix share .../cpu/processes/foo, and a
+    // pattern instance must not shadow the explicit config of bar
+    collection.resolveProcesses(
+        {{100, "Foo"}, {101, "foo"}, {102, "BAR"}, {103, "bar"}});
+    EXPECT_THAT(sink.addedNames,
+                ElementsAre("ProcessCPU_foo", "ProcessCPU_Bar"));
+}
@@ -0,0 +1,88 @@
+#include "health_metric_collector.hpp"
+
+#include <poll.h>
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+using namespace phosphor::health::metric;
+using namespace std::chrono_literals;
+
+TEST(HealthMetricCollectorTest, TestRing)
+{
+    collector::Ring<int, 4> ring;
+    int item = 0;
+    EXPECT_FALSE(ring.pop(item));
+
+    // Wrap around a few times
+    for (int round = 0; round < 3; round++)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            EXPECT_TRUE(ring.push(round * 4 + i));
+        }
+        EXPECT_FALSE(ring.push(-1));
+        for (int i = 0; i < 4; i++)
+        {
+            EXPECT_TRUE(ring.pop(item));
+            EXPECT_EQ(item, round * 4 + i);
+        }
+        EXPECT_FALSE(ring.pop(item));
+    }
+}
+
+TEST(HealthMetricCollectorTest, TestCollect)
+{
+    collector::Collector collector(10ms);
+    collector::Plan plan;
+    plan.sources.push_back({.type = Type::cpu,
+                            .name = "CPU",
+                            .subType = SubType::cpuTotal,
+                            .path = {},
+                            .pid = 0});
+    plan.sources.push_back({.type = Type::memory,
+                            .name = "Memory_Available",
+                            .subType = SubType::memoryAvailable,
+                            .path = {},
+                            .pid = 0});
+    plan.sources.push_back({.type = Type::processMemory,
+                            .name = "ProcessMemory_Self",
+                            .subType = SubType::NA,
+                            .path = {},
+                            .pid = getpid()});
+    plan.listProcesses = true;
+    collector.publish(plan);
+
+    pollfd fd{.fd = collector.getFd(), .events = POLLIN, .revents = 0};
+    ASSERT_EQ(poll(&fd, 1, 5000), 1);
+    auto batches = collector.drain();
+    ASSERT_FALSE(batches.empty());
+
+    const auto& batch = batches.front();
+    ASSERT_EQ(batch.samples.size(), plan.sources.size());
+    for (size_t i = 0; i < plan.sources.size(); i++)
+    {
+        EXPECT_EQ(batch.samples[i].name, plan.sources[i].name);
+        EXPECT_FALSE(batch.samples[i].exited);
+    }
+    EXPECT_TRUE(batch.samples[1].value.has_value());
+    EXPECT_EQ(batch.samples[2].pid, getpid());
+    EXPECT_TRUE(batch.samples[2].value.has_value());
+    ASSERT_TRUE(batch.processes.has_value());
+    EXPECT_FALSE(batch.processes->empty());
+}
+
+TEST(HealthMetricCollectorTest, TestExitedProcess)
+{
+    sampler::Sampler sampler;
+    // PIDs are limited to 2^22, this one never exists
+    auto samples = sampler.read({{.type = Type::processCPU,
+                                  .name = "ProcessCPU_Gone",
+                                  .subType = SubType::NA,
+                                  .path = {},
+                                  .pid = 1 << 23}});
+    ASSERT_EQ(samples.size(), 1);
+    EXPECT_TRUE(samples.front().exited);
+    EXPECT_FALSE(samples.front().value.has_value());
+}
@@ -1,18 +1,41 @@
 #include "health_metric_config.hpp"
 
+#include "default_health_metric_config.hpp"
+#include "health_metric_config_cache.hpp"
+
+#include <unistd.h>
+
 #include <sdbusplus/test/sdbus_mock.hpp>
 
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <set>
+#include <stdexcept>
 #include <utility>
 
 #include <gtest/gtest.h>
 
 using namespace phosphor::health;
 using namespace phosphor::health::metric::config;
+using phosphor::health::metric::ThresholdIntf;
 
 constexpr auto minConfigSize = 1;
 
+/** @brief Keep the tests off the config cache of the host */
+class ConfigCacheEnvironment : public ::testing::Environment
+{
+  public:
+    void SetUp() override
+    {
+        setCacheDirectory("");
+    }
+};
+
+static const auto* cacheEnvironment =
+    ::testing::AddGlobalTestEnvironment(new ConfigCacheEnvironment);
+
 TEST(HealthMonitorConfigTest, TestConfigSize)
 {
     auto healthMetricConfigs = getHealthMetricConfigs();
@@ -79,3 +102,101 @@ TEST(HealthMonitorConfigTest, TestConfigValues)
         EXPECT_GE(count_with_thresholds, 1);
     }
 }
+
+TEST(HealthMonitorConfigTest, TestPlatformOverride)
+{
+    static_assert(defaultHealthMetrics.size() >= minConfigSize);
+
+    auto configs = parseHealthMetricConfigs(R"({
+        "CPU": {"Window_size": 30, "Threshold": {"Warning_Upper": null}},
+        "Memory_Available": {"Threshold": {"Critical_Lower": {"Value": 10}}},
+        "Memory_Free": null,
+        "Storage_DATA": {"Path": "/data"}
+    })");
+
+    auto find = [&configs](metric::Type type, const std::string& name) {
+        auto& list = configs[type];
+        auto config = std::ranges::find(list, name, &HealthMetric::name);
+        return config != list.end() ? &*config : nullptr;
+    };
+
+    auto cpu = find(metric::Type::cpu, "CPU");
+    ASSERT_NE(cpu, nullptr);
+    EXPECT_EQ(cpu->windowSize, 30);
+    EXPECT_EQ(cpu->thresholds.size(), 1);
+    EXPECT_TRUE(cpu->thresholds.contains(
+        {ThresholdIntf::Type::Critical, ThresholdIntf::Bound::Upper}));
+
+    auto available = find(metric::Type::memory, "Memory_Available");
+    ASSERT_NE(available, nullptr);
+    auto& critical = available->thresholds.at(
+        {ThresholdIntf::Type::Critical, ThresholdIntf::Bound::Lower});
+    EXPECT_EQ(critical.value, 10);
+    EXPECT_TRUE(critical.log);
+
+    EXPECT_EQ(find(metric::Type::memory, "Memory_Free"), nullptr);
+    EXPECT_NE(find(metric::Type::memory, "Memory"), nullptr);
+
+    auto storage = find(metric::Type::storage, "Storage_DATA");
+    ASSERT_NE(storage, nullptr);
+    EXPECT_EQ(storage->path, "/data");
+    EXPECT_EQ(storage->subType, metric::SubType::NA);
+}
+
+TEST(HealthMonitorConfigTest, TestInvalidPlatformConfig)
+{
+    // A syntax error must not silently fall back to the defaults
+    EXPECT_THROW(parseHealthMetricConfigs(R"({"CPU": {"Window_size": 30})"),
+                 std::invalid_argument);
+    EXPECT_ANY_THROW(
+        parseHealthMetricConfigs(R"({"CPU": {"Window_size": "30"}})"));
+    EXPECT_ANY_THROW(parseHealthMetricConfigs(
+        R"({"CPU": {"Threshold": {"Critical_Upper": {"Value": "high"}}}})"));
+
+    // No platform config is not an error
+    EXPECT_GE(parseHealthMetricConfigs("").size(), minConfigSize);
+}
+
+TEST(HealthMonitorConfigTest, TestConfigCache)
+{
+    auto cacheFile = std::filesystem::temp_directory_path() /
+                     ("health_config_test_" + std::to_string(getpid()));
+    auto healthMetricConfigs = getHealthMetricConfigs();
+    auto key = cache::key({"default", "platform"});
+
+    // A missing cache is a miss
+    EXPECT_FALSE(cache::load(cacheFile, key).has_value());
+
+    cache::store(cacheFile, key, healthMetricConfigs);
+    auto cached = cache::load(cacheFile, key);
+    ASSERT_TRUE(cached.has_value());
+    EXPECT_EQ(*cached, healthMetricConfigs);
+
+    // A change in any source invalidates the cache
+    EXPECT_NE(cache::key({"default", "platform2"}), key);
+    EXPECT_NE(cache::key({"defaultp", "latform"}), key);
+    EXPECT_FALSE(
+        cache::load(cacheFile, cache::key({"default", "platform2"})));
+
+    // A truncated cache is a miss
+    std::filesystem::resize_file(cacheFile,
+                                 std::filesystem::file_size(cacheFile) - 1);
+    EXPECT_FALSE(cache::load(cacheFile, key).has_value());
+
+    std::filesystem::remove(cacheFile);
+}
+
+TEST(HealthMonitorConfigTest, TestConfigCacheDirectory)
+{
+    auto directory = std::filesystem::temp_directory_path() /
+                     ("health_config_cache_test_" + std::to_string(getpid()));
+    setCacheDirectory(directory);
+
+    // The first load parses and stores the cache, the second one reads it
+    auto parsed = getHealthMetricConfigs();
+    EXPECT_TRUE(std::filesystem::exists(directory / "health_config.cache"));
+    EXPECT_EQ(getHealthMetricConfigs(), parsed);
+
+    setCacheDirectory("");
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,104 @@
+#include "health_metric_openmetrics.hpp"
+
+#include <sdbusplus/test/sdbus_mock.hpp>
+#include <xyz/openbmc_project/Metric/Value/server.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace ConfigIntf = phosphor::health::metric::config;
+using PathIntf =
+    sdbusplus::server::xyz::openbmc_project::metric::Value::namespace_path;
+using namespace phosphor::health::metric;
+using namespace phosphor::health::utils;
+
+using ::testing::_;
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+class HealthMetricOpenMetricsTest : public ::testing::Test
+{
+  public:
+    sdbusplus::SdBusMock sdbusMock;
+    sdbusplus::bus_t bus = sdbusplus::get_mocked_new(&sdbusMock);
+    const std::string objPath = std::string(PathIntf::value) + "/bmc/" +
+                                PathIntf::kernel_cpu;
+    ConfigIntf::HealthMetric config;
+
+    void SetUp() override
+    {
+        config.name = "CPU_Kernel";
+        config.subType = SubType::cpuKernel;
+        config.windowSize = 1;
+        config.thresholds = {
+            {{ThresholdIntf::Type::Critical, ThresholdIntf::Bound::Upper},
+             {.value = 90.0, .log = false, .target = ""}}};
+        config.path = "";
+        HealthMetric::setwaitForActionDelay(false);
+
+        EXPECT_CALL(sdbusMock,
+                    sd_bus_emit_properties_changed_strv(_, _, _, _))
+            .WillRepeatedly(testing::Return(0));
+        EXPECT_CALL(sdbusMock, sd_bus_message_new_signal(_, _, _, _, _))
+            .WillRepeatedly(testing::Return(0));
+    }
+};
+
+TEST_F(HealthMetricOpenMetricsTest, TestRender)
+{
+    auto metric = std::make_unique<HealthMetric>(bus, Type::cpu, config,
+                                                 paths_t());
+    openmetrics::Payload payload;
+    payload.add(*metric);
+
+    auto labels = "{name=\"CPU_Kernel\",path=\"" + objPath + "\"";
+    const auto& text = payload.get();
+    EXPECT_THAT(text, HasSubstr("# TYPE bmc_health_metric gauge\n"));
+    EXPECT_THAT(text, HasSubstr("bmc_health_metric" + labels + "} NaN\n"));
+    // Thresholds are relative to the total, unknown before the first sample
+    EXPECT_THAT(text, HasSubstr("bmc_health_threshold" + labels +
+                                ",type=\"Critical\",bound=\"Upper\"} NaN\n"));
+    EXPECT_THAT(text, HasSubstr("bmc_health_threshold_asserted" + labels +
+                                ",type=\"Critical\",bound=\"Upper\"} 0\n"));
+    EXPECT_TRUE(text.ends_with("# EOF\n"));
+
+    payload.remove(*metric);
+    EXPECT_THAT(payload.get(), Not(HasSubstr("CPU_Kernel")));
+}
+
+TEST_F(HealthMetricOpenMetricsTest, TestRenderOnChange)
+{
+    auto metric = std::make_unique<HealthMetric>(bus, Type::cpu, config,
+                                                 paths_t());
+    openmetrics::Payload payload;
+    payload.add(*metric);
+    auto before = payload.get();
+
+    // Nothing changed, the NaN value and thresholds included
+    EXPECT_FALSE(payload.update(*metric));
+    EXPECT_EQ(payload.get(), before);
+
+    metric->update(MValue(1351, 1500));
+    EXPECT_TRUE(payload.update(*metric));
+    EXPECT_THAT(payload.get(),
+                HasSubstr(",type=\"Critical\",bound=\"Upper\"} 1\n"));
+    EXPECT_NE(payload.get(), before);
+
+    // The same sample again is not rendered
+    metric->update(MValue(1351, 1500));
+    EXPECT_FALSE(payload.update(*metric));
+}
+
+TEST_F(HealthMetricOpenMetricsTest, TestRenderEscaping)
+{
+    config.name = "CPU_\"Kernel\"\\\n";
+    auto metric = std::make_unique<HealthMetric>(bus, Type::cpu, config,
+                                                 paths_t());
+    openmetrics::Payload payload;
+    payload.add(*metric);
+
+    const auto& text = payload.get();
+    EXPECT_THAT(text, HasSubstr("{name=\"CPU_\\\"Kernel\\\"\\\\\\n\",path=\"" +
+                                objPath + "\"} NaN\n"));
+    EXPECT_THAT(text, Not(HasSubstr("\"Kernel\"")));
+}
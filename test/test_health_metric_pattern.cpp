@@ -0,0 +1,71 @@
+#include "health_metric_pattern.hpp"
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace pattern = phosphor::health::metric::pattern;
+
+TEST(HealthMetricPatternTest, TestMatcher)
+{
+    pattern::Matcher exact("bmcweb");
+    EXPECT_FALSE(exact.isPattern());
+    EXPECT_TRUE(exact.match("bmcweb"));
+    EXPECT_FALSE(exact.match("bmcweb2"));
+
+    pattern::Matcher glob("phosphor-*");
+    EXPECT_TRUE(glob.isPattern());
+    EXPECT_TRUE(glob.match("phosphor-log-ma"));
+    EXPECT_FALSE(glob.match("bmcweb"));
+
+    pattern::Matcher regex("/^(ipmid|netipmid)$/");
+    EXPECT_TRUE(regex.isPattern());
+    EXPECT_TRUE(regex.match("netipmid"));
+    EXPECT_FALSE(regex.match("ipmid2"));
+
+    pattern::Matcher invalid("/(/");
+    EXPECT_TRUE(invalid.isPattern());
+    EXPECT_FALSE(invalid.match("("));
+}
+
+TEST(HealthMetricPatternTest, TestInstanceName)
+{
+    EXPECT_EQ(pattern::instanceName("Storage_Auto", "/var/log"),
+              "Storage_varlog");
+    EXPECT_EQ(pattern::instanceName("Storage_Auto", "/"), "Storage_root");
+    // Lowercased like the object path, so /Data and /data collide
+    EXPECT_EQ(pattern::instanceName("Storage_Auto", "/Data"), "Storage_data");
+    EXPECT_EQ(pattern::instanceName("ProcessCPU_Phosphor", "phosphor-log-ma"),
+              "ProcessCPU_phosphorlogma");
+}
+
+TEST(HealthMetricPatternTest, TestWritableMounts)
+{
+    auto file = std::filesystem::temp_directory_path() /
+                ("mountinfo-" + std::to_string(getpid()));
+    {
+        std::ofstream mountinfo(file);
+        mountinfo
+            << "20 1 0:19 / / ro,relatime - squashfs /dev/root ro\n"
+            << "21 20 0:5 / /dev rw,nosuid - devtmpfs devtmpfs rw\n"
+            << "22 20 0:20 / /proc rw,nosuid - proc proc rw\n"
+            << "23 20 0:21 / /sys rw,nosuid - sysfs sysfs rw\n"
+            << "24 23 0:22 / /sys/kernel/debug rw - debugfs debugfs rw\n"
+            << "25 20 0:23 / /tmp rw,nosuid shared:8 - tmpfs tmpfs rw\n"
+            << "26 20 31:5 / /run/initramfs/rw rw,relatime - jffs2 mtd5 rw\n"
+            << "27 20 31:5 /var /var rw,relatime - overlay overlay rw\n"
+            << "28 20 31:5 /var /var rw,relatime - overlay overlay rw\n"
+            << "29 20 31:6 / /mnt/my\\040data rw - ext4 /dev/mmcblk0p1 rw\n"
+            << "30 20 31:7 / /mnt/rofs ro - ext4 /dev/mmcblk0p2 ro\n";
+    }
+
+    auto mounts = pattern::writableMounts(file);
+    std::filesystem::remove(file);
+
+    EXPECT_EQ(mounts, (std::vector<std::string>{"/tmp", "/run/initramfs/rw",
+                                                "/var", "/mnt/my data"}));
+}
@@ -0,0 +1,81 @@
+#include "health_metric_shm_writer.hpp"
+
+#include <unistd.h>
+
+#include <cmath>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace shm = phosphor::health::metric::shm;
+
+class HealthMetricShmTest : public ::testing::Test
+{
+  public:
+    const std::string name =
+        "/phosphor-health-monitor-test-" + std::to_string(getpid());
+};
+
+TEST_F(HealthMetricShmTest, TestPublishAndRead)
+{
+    shm::Writer writer(name);
+    shm::Reader reader(name.c_str());
+    EXPECT_TRUE(reader.valid());
+
+    auto cpu = writer.allocate("/xyz/openbmc_project/metric/bmc/cpu/total");
+    auto memory =
+        writer.allocate("/xyz/openbmc_project/metric/bmc/memory/free");
+    ASSERT_NE(cpu, nullptr);
+    ASSERT_NE(memory, nullptr);
+
+    // Freshly allocated slots are visible with an unknown value
+    auto metrics = reader.read();
+    ASSERT_EQ(metrics.size(), 2);
+    EXPECT_TRUE(std::isnan(metrics[0].value));
+
+    auto criticalUpper = shm::assertionBit(shm::ThresholdType::critical,
+                                           shm::ThresholdBound::upper);
+    writer.publish(*cpu, 95.0, criticalUpper);
+    writer.publish(*memory, 1024.0, 0);
+
+    metrics = reader.read();
+    ASSERT_EQ(metrics.size(), 2);
+    EXPECT_EQ(metrics[0].path, "/xyz/openbmc_project/metric/bmc/cpu/total");
+    EXPECT_EQ(metrics[0].value, 95.0);
+    EXPECT_EQ(metrics[0].assertions, criticalUpper);
+    EXPECT_GT(metrics[0].timestamp, 0);
+    EXPECT_EQ(metrics[1].value, 1024.0);
+    EXPECT_EQ(metrics[1].assertions, 0);
+}
+
+TEST_F(HealthMetricShmTest, TestReleaseAndReuse)
+{
+    shm::Writer writer(name);
+    shm::Reader reader(name.c_str());
+
+    auto first = writer.allocate("/xyz/openbmc_project/metric/bmc/first");
+    auto second = writer.allocate("/xyz/openbmc_project/metric/bmc/second");
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+
+    writer.release(*first);
+    auto metrics = reader.read();
+    ASSERT_EQ(metrics.size(), 1);
+    EXPECT_EQ(metrics[0].path, "/xyz/openbmc_project/metric/bmc/second");
+
+    // Released slots are reused before the segment grows
+    auto third = writer.allocate("/xyz/openbmc_project/metric/bmc/third");
+    EXPECT_EQ(third, first);
+    EXPECT_EQ(reader.read().size(), 2);
+}
+
+TEST_F(HealthMetricShmTest, TestWriterExit)
+{
+    auto writer = std::make_unique<shm::Writer>(name);
+    shm::Reader reader(name.c_str());
+    EXPECT_TRUE(reader.valid());
+
+    writer.reset();
+    EXPECT_FALSE(reader.valid());
+    EXPECT_THROW(shm::Reader{name.c_str()}, std::system_error);
+}
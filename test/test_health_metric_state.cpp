@@ -0,0 +1,97 @@
+#include "health_metric.hpp"
+#include "health_metric_serialize.hpp"
+#include "health_metric_state.hpp"
+
+#include <unistd.h>
+
+#include <sdbusplus/test/sdbus_mock.hpp>
+
+#include <filesystem>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace ConfigIntf = phosphor::health::metric::config;
+using namespace phosphor::health::metric;
+
+using ::testing::_;
+using ::testing::Return;
+
+class HealthMetricStateTest : public ::testing::Test
+{
+  public:
+    sdbusplus::SdBusMock sdbusMock;
+    sdbusplus::bus_t bus = sdbusplus::get_mocked_new(&sdbusMock);
+    const std::string file = "/tmp/phosphor-health-monitor-test-state-" +
+                             std::to_string(getpid());
+    ConfigIntf::HealthMetric config;
+
+    void SetUp() override
+    {
+        config.name = "CPU_Kernel";
+        config.subType = SubType::cpuKernel;
+        config.windowSize = 2;
+        config.thresholds = {
+            {{ThresholdIntf::Type::Critical, ThresholdIntf::Bound::Upper},
+             {.value = 90.0, .log = false, .target = ""}}};
+        config.path = "";
+        HealthMetric::setwaitForActionDelay(false);
+        EXPECT_CALL(sdbusMock,
+                    sd_bus_emit_properties_changed_strv(_, _, _, _))
+            .WillRepeatedly(Return(0));
+    }
+
+    void TearDown() override
+    {
+        HealthMetric::setStore(nullptr);
+        std::filesystem::remove(file);
+    }
+};
+
+TEST_F(HealthMetricStateTest, TestRestore)
+{
+    const auto critical = HealthMetric::assertionBit(
+        ThresholdIntf::Type::Critical, ThresholdIntf::Bound::Upper);
+    {
+        state::Store store(file, std::chrono::seconds(60));
+        auto metric = std::make_unique<HealthMetric>(bus, Type::cpu, config,
+                                                     paths_t());
+        store.added(*metric);
+        metric->update(MValue(95, 100));
+        metric->update(MValue(97, 100));
+        EXPECT_EQ(metric->getAssertionMask(), critical);
+        store.save();
+        store.removed(*metric);
+    }
+
+    state::Store store(file, std::chrono::seconds(60));
+    ASSERT_TRUE(store.load());
+    HealthMetric::setStore(&store);
+    auto metric = std::make_unique<HealthMetric>(bus, Type::cpu, config,
+                                                 paths_t());
+
+    // The assertion and the sample window survive the restart
+    EXPECT_EQ(metric->getAssertionMask(), critical);
+    auto restored = metric->getState();
+    EXPECT_EQ(restored.history, (std::vector<double>{95, 97}));
+    EXPECT_EQ(metric->ValueIntf::value(), 97);
+
+    // The restored window is complete, so one low sample deasserts
+    metric->update(MValue(10, 100));
+    metric->update(MValue(10, 100));
+    EXPECT_EQ(metric->getAssertionMask(), 0);
+}
+
+TEST_F(HealthMetricStateTest, TestInvalidFile)
+{
+    state::Store store(file, std::chrono::seconds(60));
+    EXPECT_FALSE(store.load());
+
+    serialize::Writer writer;
+    writer.put(uint32_t{0});
+    ASSERT_FALSE(serialize::replaceFile(file, writer.buffer));
+    EXPECT_FALSE(store.load());
+    EXPECT_EQ(store.find("/xyz/openbmc_project/metric/bmc/cpu/kernel"),
+              nullptr);
+}
@@ -0,0 +1,90 @@
+#include "health_rate_limiter.hpp"
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+namespace ratelimit = phosphor::health::ratelimit;
+using namespace std::chrono_literals;
+using Threshold = ratelimit::Threshold;
+
+class HealthRateLimiterTest : public ::testing::Test
+{
+  protected:
+    ratelimit::RateLimiter limiter;
+    ratelimit::clock_t::time_point now{};
+    ratelimit::Key key{"CPU", Threshold::Type::Critical,
+                       Threshold::Bound::Upper, "reboot.target"};
+};
+
+TEST_F(HealthRateLimiterTest, TestBurstAndRefill)
+{
+    ratelimit::Limit limit{.burst = 2, .period = 10s};
+
+    EXPECT_TRUE(limiter.allow(key, limit, now));
+    EXPECT_TRUE(limiter.allow(key, limit, now + 1s));
+    EXPECT_FALSE(limiter.allow(key, limit, now + 2s));
+    // Tokens are earned continuously, one every 10s after the first take
+    EXPECT_FALSE(limiter.allow(key, limit, now + 9s));
+    EXPECT_TRUE(limiter.allow(key, limit, now + 10s));
+    EXPECT_FALSE(limiter.allow(key, limit, now + 11s));
+}
+
+TEST_F(HealthRateLimiterTest, TestIndependentKeys)
+{
+    ratelimit::Limit limit{.burst = 1, .period = 60s};
+    auto warning = key;
+    warning.type = Threshold::Type::Warning;
+    auto lower = key;
+    lower.bound = Threshold::Bound::Lower;
+    auto otherTarget = key;
+    otherTarget.target = "poweroff.target";
+
+    EXPECT_TRUE(limiter.allow(key, limit, now));
+    EXPECT_FALSE(limiter.allow(key, limit, now));
+    EXPECT_TRUE(limiter.allow(warning, limit, now));
+    EXPECT_TRUE(limiter.allow(lower, limit, now));
+    EXPECT_TRUE(limiter.allow(otherTarget, limit, now));
+}
+
+TEST_F(HealthRateLimiterTest, TestUnlimited)
+{
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_TRUE(limiter.allow(key, {.burst = 1, .period = 0s}, now));
+    }
+    EXPECT_EQ(limiter.size(), 0);
+}
+
+TEST_F(HealthRateLimiterTest, TestPrune)
+{
+    ratelimit::Limit limit{.burst = 1, .period = 10s};
+    for (int i = 0; i < 256; i++)
+    {
+        key.metric = "Metric" + std::to_string(i);
+        EXPECT_TRUE(limiter.allow(key, limit, now));
+    }
+    EXPECT_EQ(limiter.size(), 256);
+
+    // All buckets refilled, so they are dropped on the next new key
+    key.metric = "Metric";
+    EXPECT_TRUE(limiter.allow(key, limit, now + 10s));
+    EXPECT_EQ(limiter.size(), 1);
+    EXPECT_FALSE(limiter.allow(key, limit, now + 11s));
+}
+
+TEST_F(HealthRateLimiterTest, TestRestore)
+{
+    ratelimit::Limit limit{.burst = 1, .period = 60s};
+    EXPECT_TRUE(limiter.allow(key, limit, now));
+    auto entries = limiter.entries(now + 10s);
+    ASSERT_EQ(entries.size(), 1);
+    EXPECT_EQ(entries[0].key, key);
+    EXPECT_TRUE(limiter.entries(now + 60s).empty());
+
+    // A restarted limiter keeps limiting until the bucket refills
+    ratelimit::RateLimiter restarted;
+    restarted.restore(entries);
+    EXPECT_FALSE(restarted.allow(key, limit, now + 30s));
+    EXPECT_TRUE(restarted.allow(key, limit, now + 60s));
+}
@@ -0,0 +1,130 @@
+#include "ipc/messageCounter.hpp"
+
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace phosphor::ipc;
+
+TEST(IpcMessageCounterTest, TestCount)
+{
+    MessageCounter counter;
+    counter.count(":1.10", "PropertiesChanged", MessageType::signal);
+    counter.count(":1.10", "PropertiesChanged", MessageType::signal);
+    counter.count(":1.10", "GetAll", MessageType::methodCall);
+    counter.count(":1.11", "", MessageType::methodReturn);
+    counter.count(":1.11", "", MessageType::methodError);
+
+    auto tick = counter.cut(std::chrono::seconds(2));
+    EXPECT_EQ(tick.duration.count(), 2);
+    ASSERT_EQ(tick.senders.size(), 2);
+    EXPECT_EQ(tick.senders[":1.10"], (MessageTick::counts_t{1, 0, 0, 2}));
+    EXPECT_EQ(tick.senders[":1.11"], (MessageTick::counts_t{0, 1, 1, 0}));
+
+    // Returns and errors have no member
+    ASSERT_EQ(tick.members.size(), 2);
+    EXPECT_EQ(tick.members["PropertiesChanged"], 2);
+    EXPECT_EQ(tick.members["GetAll"], 1);
+
+    // The next tick starts empty
+    counter.count(":1.12", "Ping", MessageType::methodCall);
+    tick = counter.cut(std::chrono::seconds(1));
+    EXPECT_EQ(tick.senders.size(), 1);
+    EXPECT_FALSE(tick.senders.contains(":1.10"));
+    EXPECT_EQ(tick.senders[":1.12"], (MessageTick::counts_t{1, 0, 0, 0}));
+    EXPECT_EQ(tick.members.size(), 1);
+
+    // Kept senders count from zero again, idle ones are not handed over
+    counter.count(":1.12", "Ping", MessageType::methodCall);
+    tick = counter.cut(std::chrono::seconds(1));
+    EXPECT_EQ(tick.senders[":1.12"], (MessageTick::counts_t{1, 0, 0, 0}));
+    EXPECT_EQ(tick.members["Ping"], 1);
+    tick = counter.cut(std::chrono::seconds(1));
+    EXPECT_TRUE(tick.senders.empty());
+    EXPECT_TRUE(tick.members.empty());
+}
+
+TEST(IpcMessageCounterTest, TestMessageType)
+{
+    EXPECT_EQ(getMessageType("MethodCalls"), MessageType::methodCall);
+    EXPECT_EQ(getMessageType("MethodReturns"), MessageType::methodReturn);
+    EXPECT_EQ(getMessageType("Errors"), MessageType::methodError);
+    EXPECT_EQ(getMessageType("Signals"), MessageType::signal);
+    EXPECT_FALSE(getMessageType("Messages"));
+}
+
+TEST(IpcMessageCounterTest, TestMessageRates)
+{
+    MessageCounter counter;
+    for (int i = 0; i < 10; i++)
+    {
+        counter.count(":1.10", "PropertiesChanged", MessageType::signal);
+    }
+    counter.count(":1.10", "GetAll", MessageType::methodCall);
+    counter.count(":1.11", "", MessageType::methodReturn);
+    // The bus driver is not a peer
+    counter.count("org.freedesktop.DBus", "NameOwnerChanged",
+                  MessageType::signal);
+    auto tick = counter.cut(std::chrono::seconds(2));
+
+    // Signals, Messages and MethodCalls
+    std::vector<std::optional<MessageType>> types = {
+        MessageType::signal, std::nullopt, MessageType::methodCall};
+    auto rates = getMessageRates(tick, types);
+    ASSERT_EQ(rates.size(), 2);
+    EXPECT_EQ(rates[":1.10"],
+              (std::vector<std::pair<size_t, double>>{
+                  {0, 5.0}, {1, 5.5}, {2, 0.5}}));
+    EXPECT_EQ(rates[":1.11"],
+              (std::vector<std::pair<size_t, double>>{
+                  {0, 0.0}, {1, 0.5}, {2, 0.0}}));
+
+    // An empty tick has no rate
+    tick.duration = std::chrono::seconds(0);
+    EXPECT_TRUE(getMessageRates(tick, types).empty());
+}
+
+TEST(IpcMessageCounterTest, TestMessageKey)
+{
+    EXPECT_TRUE(isMessageKey("Messages"));
+    EXPECT_TRUE(isMessageKey("Signals"));
+    EXPECT_FALSE(isMessageKey("Signal"));
+    EXPECT_FALSE(isMessageKey("IncomingBytes"));
+}
+
+TEST(IpcMessageCounterTest, TestQuietSenders)
+{
+    QuietSenders quiet(2);
+    rates_t rates = {{":1.10", {{0, 5.0}, {1, 6.0}}}};
+    quiet.fill(rates, 2);
+    EXPECT_EQ(quiet.size(), 1);
+
+    // A quiet sender is reported at 0 for a couple of ticks
+    for (auto tick = 0; tick < 2; tick++)
+    {
+        rates = {{":1.11", {{0, 1.0}, {1, 1.0}}}};
+        quiet.fill(rates, 2);
+        ASSERT_EQ(rates.size(), 2);
+        EXPECT_EQ(rates[":1.10"],
+                  (std::vector<std::pair<size_t, double>>{{0, 0.0}, {1, 0.0}}));
+    }
+
+    // Sending again restarts the count
+    rates = {{":1.10", {{0, 2.0}, {1, 2.0}}}};
+    quiet.fill(rates, 2);
+    EXPECT_EQ(rates[":1.10"],
+              (std::vector<std::pair<size_t, double>>{{0, 2.0}, {1, 2.0}}));
+    EXPECT_EQ(rates[":1.11"],
+              (std::vector<std::pair<size_t, double>>{{0, 0.0}, {1, 0.0}}));
+
+    // And is forgotten once quiet for longer
+    for (auto tick = 0; tick < 3; tick++)
+    {
+        rates.clear();
+        quiet.fill(rates, 2);
+    }
+    EXPECT_TRUE(rates.empty());
+    EXPECT_EQ(quiet.size(), 0);
+}
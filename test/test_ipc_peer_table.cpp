@@ -0,0 +1,59 @@
+#include "ipc/peerTable.hpp"
+
+#include <gtest/gtest.h>
+
+using phosphor::ipc::PeerTable;
+
+class IpcPeerTableTest : public ::testing::Test
+{
+  public:
+    PeerTable<int> table{2, 3};
+};
+
+TEST_F(IpcPeerTableTest, TestIntern)
+{
+    table.beginGeneration();
+    auto first = table.intern(":1.10");
+    auto second = table.intern(":1.11");
+    ASSERT_TRUE(first && second);
+    EXPECT_NE(*first, *second);
+    EXPECT_EQ(table.intern(":1.10"), first);
+    EXPECT_EQ(table.find(":1.11"), second);
+    EXPECT_FALSE(table.find(":1.12"));
+    EXPECT_EQ(table.name(*second), ":1.11");
+
+    table.state(*first, 1) = 42;
+    EXPECT_EQ(table.state(*first, 0), 0);
+    EXPECT_EQ(table.state(*first, 1), 42);
+}
+
+TEST_F(IpcPeerTableTest, TestEviction)
+{
+    table.beginGeneration();
+    auto gone = table.intern(":1.10");
+    table.intern(":1.11");
+    table.state(*gone, 0) = 1;
+    EXPECT_EQ(table.sweep(), 0);
+
+    // Only :1.11 is seen in the next read
+    table.beginGeneration();
+    table.intern(":1.11");
+    EXPECT_EQ(table.sweep(), 1);
+    EXPECT_EQ(table.size(), 1);
+    EXPECT_FALSE(table.find(":1.10"));
+
+    // The slot is reused with a fresh state
+    auto reused = table.intern(":1.12");
+    EXPECT_EQ(reused, gone);
+    EXPECT_EQ(table.state(*reused, 0), 0);
+}
+
+TEST_F(IpcPeerTableTest, TestCapacity)
+{
+    table.beginGeneration();
+    EXPECT_TRUE(table.intern(":1.1"));
+    EXPECT_TRUE(table.intern(":1.2"));
+    EXPECT_TRUE(table.intern(":1.3"));
+    EXPECT_FALSE(table.intern(":1.4"));
+    EXPECT_EQ(table.size(), 3);
+}
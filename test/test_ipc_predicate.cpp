@@ -0,0 +1,43 @@
+#include "ipc/predicate.hpp"
+
+#include <limits>
+
+#include <gtest/gtest.h>
+
+using phosphor::ipc::Operator;
+using phosphor::ipc::Predicate;
+using Bound = phosphor::health::ratelimit::Threshold::Bound;
+
+TEST(IpcPredicateTest, TestCompile)
+{
+    auto greater = Predicate::compile("greater_than");
+    auto less = Predicate::compile("less_than");
+    auto equal = Predicate::compile("equal");
+    ASSERT_TRUE(greater && less && equal);
+    EXPECT_EQ(greater->op, Operator::greaterThan);
+    EXPECT_EQ(less->op, Operator::lessThan);
+    EXPECT_EQ(equal->op, Operator::equal);
+    EXPECT_EQ(greater->bound(), Bound::Upper);
+    EXPECT_EQ(less->bound(), Bound::Lower);
+    EXPECT_FALSE(Predicate::compile("greater"));
+    EXPECT_FALSE(Predicate::compile(""));
+}
+
+TEST(IpcPredicateTest, TestEvaluate)
+{
+    auto greater = *Predicate::compile("greater_than");
+    auto less = *Predicate::compile("less_than");
+    auto equal = *Predicate::compile("equal");
+    EXPECT_TRUE(greater(11, 10));
+    EXPECT_FALSE(greater(10, 10));
+    EXPECT_TRUE(less(9, 10));
+    EXPECT_FALSE(less(10, 10));
+    EXPECT_TRUE(equal(10, 10));
+    EXPECT_FALSE(equal(9, 10));
+
+    // Unset thresholds are never crossed
+    auto unset = std::numeric_limits<double>::quiet_NaN();
+    EXPECT_FALSE(greater(11, unset));
+    EXPECT_FALSE(less(9, unset));
+    EXPECT_FALSE(equal(unset, unset));
+}
@@ -0,0 +1,26 @@
+#include "ipc/queueGrowth.hpp"
+
+#include <gtest/gtest.h>
+
+using phosphor::ipc::getQueueGrowth;
+using namespace std::chrono_literals;
+
+TEST(IpcQueueGrowthTest, TestGrowth)
+{
+    EXPECT_EQ(getQueueGrowth(1000, 3000, 2s), 1000);
+    EXPECT_EQ(getQueueGrowth(3000, 3000, 2s), 0);
+    EXPECT_EQ(getQueueGrowth(0, 4294967295u, 1s), 4294967295.0);
+}
+
+TEST(IpcQueueGrowthTest, TestDrain)
+{
+    // A draining queue is reported, not taken for a counter reset
+    EXPECT_EQ(getQueueGrowth(3000, 1000, 2s), -1000);
+    EXPECT_EQ(getQueueGrowth(4294967295u, 0, 1s), -4294967295.0);
+}
+
+TEST(IpcQueueGrowthTest, TestNoElapsedTime)
+{
+    EXPECT_FALSE(getQueueGrowth(1000, 3000, 0s));
+    EXPECT_FALSE(getQueueGrowth(1000, 3000, -1s));
+}
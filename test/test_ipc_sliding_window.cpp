@@ -0,0 +1,49 @@
+#include "ipc/slidingWindow.hpp"
+
+#include <gtest/gtest.h>
+
+using phosphor::ipc::SlidingWindow;
+
+TEST(IpcSlidingWindowTest, TestAverage)
+{
+    SlidingWindow<long int> window(3);
+    EXPECT_TRUE(window.empty());
+    EXPECT_EQ(window.average(), 0);
+
+    window.push(3);
+    window.push(6);
+    EXPECT_FALSE(window.full());
+    EXPECT_EQ(window.average(), 4.5);
+
+    window.push(9);
+    EXPECT_TRUE(window.full());
+    EXPECT_EQ(window.average(), 6);
+
+    // The oldest sample is replaced
+    window.push(12);
+    EXPECT_EQ(window.size(), 3);
+    EXPECT_EQ(window.average(), 9);
+
+    window.clear();
+    EXPECT_TRUE(window.empty());
+    EXPECT_EQ(window.capacity(), 3);
+    window.push(1);
+    EXPECT_EQ(window.average(), 1);
+}
+
+TEST(IpcSlidingWindowTest, TestRunningSum)
+{
+    SlidingWindow<double> window(4);
+    for (int sample = 0; sample < 1000; sample++)
+    {
+        window.push(sample * 0.1);
+    }
+    EXPECT_NEAR(window.average(), 99.75, 1e-9);
+
+    // A zero capacity still keeps the latest sample
+    SlidingWindow<double> single(0);
+    single.push(1.5);
+    single.push(2.5);
+    EXPECT_TRUE(single.full());
+    EXPECT_EQ(single.average(), 2.5);
+}
@@ -0,0 +1,136 @@
+#include "ipc/statsDecoder.hpp"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using phosphor::ipc::StatsDecoder;
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Optional;
+
+static constexpr auto peerAccounting =
+    "org.bus1.DBus.Debug.Stats.PeerAccounting";
+
+class IpcStatsDecoderTest : public ::testing::Test
+{
+  public:
+    using counters_t = std::vector<std::optional<uint32_t>>;
+
+    sd_bus* bus = nullptr;
+    sd_bus_message* reply = nullptr;
+    int peer = -1;
+    /** @brief Counters passed to the handler by peer */
+    std::map<std::string, counters_t> peers;
+
+    void SetUp() override
+    {
+        // Messages can only be created on a started bus, this one is never
+        // connected to a broker and only used to build the replies
+        int fds[2];
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+        peer = fds[1];
+        ASSERT_GE(sd_bus_new(&bus), 0);
+        ASSERT_GE(sd_bus_set_fd(bus, fds[0], fds[0]), 0);
+        ASSERT_GE(sd_bus_start(bus), 0);
+        ASSERT_GE(sd_bus_message_new_signal(
+                      bus, &reply, "/org/freedesktop/DBus",
+                      "org.freedesktop.DBus.Debug.Stats", "GetStats"),
+                  0);
+    }
+
+    void TearDown() override
+    {
+        sd_bus_message_unref(reply);
+        sd_bus_close_unref(bus);
+        close(peer);
+    }
+
+    /** @brief Seal the reply and decode it */
+    auto decode(StatsDecoder& decoder) -> bool
+    {
+        EXPECT_GE(sd_bus_message_seal(reply, 1, 0), 0);
+        EXPECT_GE(sd_bus_message_rewind(reply, 1), 0);
+        return decoder.decode(reply, [this](std::string_view name,
+                                            StatsDecoder::counters_t counters) {
+            peers.emplace(name, counters_t(counters.begin(), counters.end()));
+        });
+    }
+};
+
+TEST_F(IpcStatsDecoderTest, TestDecode)
+{
+    StatsDecoder decoder({"OutgoingBytes", "IncomingBytes"});
+    ASSERT_GE(sd_bus_message_append(
+                  reply, "a{sv}", 3, "Serial", "u", 42u, peerAccounting,
+                  "a(sa{sv}a{su})", 3,
+                  // Peer properties and unknown counters are skipped
+                  ":1.10", 2, "UnixUserID", "u", 0u, "ProcessID", "u", 123u,
+                  4, "IncomingFds", 1u, "OutgoingBytes", 512u, "Matches", 3u,
+                  "IncomingBytes", 256u,
+                  // A missing counter is unset
+                  ":1.11", 0, 1, "IncomingBytes", 128u,
+                  // Peers with none of the counters are not reported
+                  ":1.12", 0, 1, "OutgoingFds", 2u, "Version", "s", "1"),
+              0);
+
+    EXPECT_TRUE(decode(decoder));
+    EXPECT_EQ(peers.size(), 2);
+    EXPECT_THAT(peers[":1.10"], ElementsAre(Optional(512u), Optional(256u)));
+    EXPECT_THAT(peers[":1.11"], ElementsAre(std::nullopt, Optional(128u)));
+}
+
+TEST_F(IpcStatsDecoderTest, TestDuplicateKeys)
+{
+    // The same counter may be monitored as a value and as a rate
+    StatsDecoder decoder({"IncomingBytes", "IncomingBytes"});
+    ASSERT_GE(sd_bus_message_append(reply, "a{sv}", 1, peerAccounting,
+                                    "a(sa{sv}a{su})", 1, ":1.10", 0, 2,
+                                    "IncomingBytes", 100u, "IncomingBytes",
+                                    200u),
+              0);
+
+    EXPECT_TRUE(decode(decoder));
+    // The last occurrence in the reply wins
+    EXPECT_THAT(peers[":1.10"], ElementsAre(Optional(200u), Optional(200u)));
+}
+
+TEST_F(IpcStatsDecoderTest, TestNoPeers)
+{
+    StatsDecoder decoder({"IncomingBytes"});
+    ASSERT_GE(sd_bus_message_append(reply, "a{sv}", 1, peerAccounting,
+                                    "a(sa{sv}a{su})", 0),
+              0);
+
+    EXPECT_TRUE(decode(decoder));
+    EXPECT_THAT(peers, IsEmpty());
+}
+
+TEST_F(IpcStatsDecoderTest, TestMalformed)
+{
+    StatsDecoder decoder({"IncomingBytes"});
+    // PeerAccounting of the wrong type
+    ASSERT_GE(sd_bus_message_append(reply, "a{sv}", 1, peerAccounting, "a{su}",
+                                    1, "IncomingBytes", 100u),
+              0);
+
+    EXPECT_FALSE(decode(decoder));
+    EXPECT_THAT(peers, IsEmpty());
+}
+
+TEST_F(IpcStatsDecoderTest, TestNotADictionary)
+{
+    StatsDecoder decoder({"IncomingBytes"});
+    ASSERT_GE(sd_bus_message_append(reply, "u", 42u), 0);
+
+    EXPECT_FALSE(decode(decoder));
+}
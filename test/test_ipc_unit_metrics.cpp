@@ -0,0 +1,94 @@
+#include "ipc/unitMetrics.hpp"
+
+#include <sdbusplus/test/sdbus_mock.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace phosphor::ipc;
+
+using ::testing::_;
+using ::testing::NotNull;
+using ::testing::Return;
+using ::testing::StrEq;
+
+class IpcUnitMetricsTest : public ::testing::Test
+{
+  public:
+    sdbusplus::SdBusMock sdbusMock;
+    sdbusplus::bus_t bus = sdbusplus::get_mocked_new(&sdbusMock);
+    IPCConfig config;
+
+    void SetUp() override
+    {
+        config.name = "dbus";
+        for (const auto& key : {"OutgoingBytes", "IncomingBytes"})
+        {
+            ParamConfig param;
+            param.key = key;
+            param.name = key;
+            param.operatorType = "greater_than";
+            param.predicate = *Predicate::compile(param.operatorType);
+            param.warningHigh = 100;
+            param.criticalHigh = 200;
+            config.paramConfig.push_back(param);
+        }
+    }
+};
+
+TEST_F(IpcUnitMetricsTest, TestAggregation)
+{
+    // One Value change for each parameter, the second read has the same
+    // sums, and one Asserted change for the warning
+    EXPECT_CALL(sdbusMock,
+                sd_bus_emit_properties_changed_strv(
+                    _, _, StrEq(ValueIntf::interface), NotNull()))
+        .Times(2)
+        .WillRepeatedly(Return(0));
+    EXPECT_CALL(sdbusMock,
+                sd_bus_emit_properties_changed_strv(
+                    _, _, StrEq(ThresholdIntf::interface), NotNull()))
+        .Times(1)
+        .WillRepeatedly(Return(0));
+
+    UnitMetrics metrics(bus, config);
+    metrics.add("foo.service", 0, 60, true, false);
+    metrics.add("foo.service", 0, 40, false, false);
+    metrics.add("foo.service", 1, 10, false, false);
+    metrics.commit();
+    EXPECT_EQ(metrics.size(), 1);
+
+    metrics.add("foo.service", 0, 30, true, false);
+    metrics.add("foo.service", 0, 70, false, false);
+    metrics.add("foo.service", 1, 10, false, false);
+    metrics.commit();
+}
+
+TEST_F(IpcUnitMetricsTest, TestRetention)
+{
+    EXPECT_CALL(sdbusMock, sd_bus_emit_properties_changed_strv(_, _, _, _))
+        .WillRepeatedly(Return(0));
+
+    UnitMetrics metrics(bus, config);
+    metrics.add("foo.service", 0, 1, false, false);
+    metrics.add("bar.service", 0, 1, false, false);
+    metrics.commit();
+    EXPECT_EQ(metrics.size(), 2);
+
+    // bar.service is kept while it may only be restarting
+    for (size_t read = 0; read < UnitMetrics::retainReads; read++)
+    {
+        metrics.add("foo.service", 0, 1, false, false);
+        metrics.commit();
+        EXPECT_EQ(metrics.size(), 2);
+    }
+
+    metrics.add("foo.service", 0, 1, false, false);
+    metrics.commit();
+    EXPECT_EQ(metrics.size(), 1);
+
+    // A returning unit is published again
+    metrics.add("bar.service", 1, 1, false, false);
+    metrics.commit();
+    EXPECT_EQ(metrics.size(), 2);
+}
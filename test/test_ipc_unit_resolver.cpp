@@ -0,0 +1,24 @@
+#include "ipc/unitResolver.hpp"
+
+#include <gtest/gtest.h>
+
+using phosphor::ipc::UnitResolver;
+
+TEST(IpcUnitResolverTest, TestUnescape)
+{
+    EXPECT_EQ(UnitResolver::unescape(
+                  "phosphor_2dcertificate_2dmanager_40bmcweb_2eservice"),
+              "phosphor-certificate-manager@bmcweb.service");
+    EXPECT_EQ(UnitResolver::unescape("xyz_2eopenbmc_5fproject_2eservice"),
+              "xyz.openbmc_project.service");
+    EXPECT_EQ(UnitResolver::unescape("_"), "");
+    EXPECT_EQ(UnitResolver::unescape("plain"), "plain");
+}
+
+TEST(IpcUnitResolverTest, TestUnescapeInvalid)
+{
+    // Underscores not followed by two hex digits are kept
+    EXPECT_EQ(UnitResolver::unescape("a_zz"), "a_zz");
+    EXPECT_EQ(UnitResolver::unescape("a_2"), "a_2");
+    EXPECT_EQ(UnitResolver::unescape("a_"), "a_");
+}